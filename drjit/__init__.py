@@ -58,7 +58,7 @@ import drjit.tensor as tensor # noqa
 self = vars()
 base = self['ArrayBase']
 for k, v in router.__dict__.items():
-    if k.startswith('_') or (k[0].isupper() and not k == 'CustomOp'):
+    if k.startswith('_') or (k[0].isupper() and k not in ('CustomOp', 'ADTape')):
         continue
     if k.startswith('op_'):
         setattr(base, '__' + k[3:] + '__', v)
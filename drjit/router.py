@@ -4086,6 +4086,64 @@ def accum_grad(dst, src):
             accum_grad(getattr(dst, k), getattr(src, k) if ve else src)
 
 
+def _check_sparse_grad(name, arg):
+    ta = type(arg)
+    if not _dr.is_diff_v(ta) or not ta.IsFloat or _dr.depth_v(ta) != 1 \
+            or _dr.is_tensor_v(ta):
+        raise TypeError(f'{name}(): expected a differentiable flat floating '
+                        'point array!')
+
+
+def grad_sparse(arg):
+    '''
+    Return the gradient of a variable as a list of ``(offset, value)`` pairs.
+
+    When a small part of a large array (e.g., an embedding table or texture
+    atlas) is accessed via :py:func:`drjit.gather`, the backward pass records
+    the gradient in sparse form instead of adding it to a buffer that is
+    mostly zero. The same happens for all gathers when traversing with
+    ``ADFlag.CombineGathers``. :py:func:`drjit.grad` converts it into a dense
+    array, while this function returns the stored entries. Values with the same
+    offset must be added. A dense gradient is returned with offsets
+    ``dr.arange(...)``.
+
+    Sparse gradients are only recorded when the flag
+    :py:attr:`drjit.JitFlag.ADOptimize` is set.
+
+    Args:
+        arg (object): A flat Dr.Jit differentiable floating point array.
+
+    Returns:
+        tuple: A pair ``(offsets, values)`` of an unsigned 32 bit integer
+        array and an array of the detached type of ``arg``.
+    '''
+    _check_sparse_grad('grad_sparse', arg)
+    return arg.grad_sparse_()
+
+
+def accum_grad_into(arg, target):
+    '''
+    Add the gradient of a variable to ``target`` (in place).
+
+    This is equivalent to ``target += dr.grad(arg)`` but scatters sparse
+    gradients (see :py:func:`drjit.grad_sparse`) directly into ``target``.
+    Optimizers can use it to update large parameter arrays, of which only few
+    entries received gradients, without converting the gradient into a dense
+    array first.
+
+    Args:
+        arg (object): A flat Dr.Jit differentiable floating point array.
+
+        target (object): An array of the detached type of ``arg`` with the
+          same size.
+    '''
+    _check_sparse_grad('accum_grad_into', arg)
+    if type(target) is not _dr.detached_t(type(arg)):
+        raise TypeError('accum_grad_into(): \'target\' must have the detached '
+                        'type of \'arg\'!')
+    arg.accum_grad_into_(target)
+
+
 def grad_enabled(*args):
     '''
     Return whether gradient tracking is enabled on any of the given variables.
@@ -4333,6 +4391,15 @@ def traverse(dtype, mode, flags=_dr.ADFlag.Default):
     - ``ADFlag.ClearVertices``: clear gradients of processed vertices only, but leave edges intact
     - ``ADFlag.Default``: clear everything (default behaviour)
 
+    In addition, ``ADFlag.Parallel`` requests that independent edges of each
+    topological level are processed concurrently. This currently only affects
+    the scalar AD variants and is ignored by the JIT-compiled array types.
+
+    ``ADFlag.CombineGathers`` defers the backward scatters of
+    :py:func:`drjit.gather` operations, so that gathers from the same array
+    that share their offsets and mask perform a single scatter. This requires
+    ``JitFlag.ADOptimize``.
+
     Args:
         dtype (type): defines the Dr.JIT array type used to build the AD graph
 
@@ -4351,6 +4418,88 @@ def traverse(dtype, mode, flags=_dr.ADFlag.Default):
     dtype.traverse_(mode, flags)
 
 
+class ADTape:
+    '''
+    Capture the AD traversal of a computation graph and replay it when a graph
+    with the same structure is constructed again.
+
+    Optimization loops often rebuild an identical computation graph in every
+    iteration. The edges that need to be traversed, and their order, then do
+    not change. An ``ADTape`` captures this schedule during the first
+    backward pass and reuses it in subsequent iterations, which skips the graph
+    search and sorting steps of :py:func:`drjit.traverse`.
+
+    The tape tracks the differentiable operations performed within its
+    ``with`` block. Variables created outside of it (e.g., the parameters being
+    optimized) may change between iterations. An exception is raised when the
+    graph no longer matches the captured one.
+
+    .. code-block::
+
+        tape = dr.ADTape(dr.llvm.ad.Float)
+        for i in range(n):
+            dr.enable_grad(x)
+            with tape:
+                loss = f(x)
+                tape.backward(loss)
+            x = dr.detach(x) - lr * dr.grad(x)
+
+    Args:
+        dtype (type): the Dr.Jit array type used to build the AD graph
+    '''
+
+    def __init__(self, dtype):
+        dtype = _dr.leaf_array_t(dtype)
+        if not _dr.is_diff_v(dtype) or not dtype.IsFloat:
+            raise TypeError('ADTape(): expected a differentiable floating '
+                            'point array type!')
+        self.dtype = dtype
+        self.index = dtype.tape_new_()
+
+    def __del__(self):
+        if hasattr(self, 'index'):
+            self.dtype.tape_free_(self.index)
+
+    def __enter__(self):
+        self.dtype.tape_begin_(self.index)
+        return self
+
+    def __exit__(self, exc_type, exc_val, exc_tb):
+        self.dtype.tape_end_()
+
+    @property
+    def recorded(self):
+        '''Has the tape already captured a traversal?'''
+        return self.dtype.tape_recorded_(self.index)
+
+    def backward(self, arg, flags=_dr.ADFlag.Default):
+        '''
+        Backward-propagate gradients from ``arg``, like
+        :py:func:`drjit.backward_from`. The first call captures the traversal,
+        later calls replay it.
+
+        Args:
+            arg (object): A Dr.Jit differentiable array instance.
+
+            flags (ADFlag | int): flags to control what should and should not
+              be destructed during the traversal. The default value is
+              ``ADFlag.Default``.
+        '''
+        if not self.recorded:
+            backward_from(arg, flags)
+            return
+
+        ta = type(arg)
+        _check_grad_enabled('ADTape.backward', ta, arg)
+
+        # Deduplicate components if 'a' is a vector
+        if _dr.depth_v(arg) > 1:
+            arg = arg + ta(0)
+
+        set_grad(arg, _dr.ones(ta))
+        self.dtype.tape_replay_(flags)
+
+
 def _check_grad_enabled(name, t, a):
     if _dr.is_diff_v(t) and t.IsFloat:
         if _dr.flag(_dr.JitFlag.VCallRecord) and not grad_enabled(a):
@@ -4524,6 +4673,77 @@ def backward(arg, flags=_dr.ADFlag.Default):
     backward_from(arg, flags)
 
 
+def _leaves(arg):
+    '''Return the leaf arrays of a (possibly nested) Dr.Jit array'''
+    if _dr.depth_v(arg) > 1:
+        return [leaf for value in arg for leaf in _leaves(value)]
+    return [arg]
+
+
+def _unflatten(like, leaves):
+    '''Inverse of _leaves(): assemble an array shaped like ``like``'''
+    if _dr.depth_v(like) > 1:
+        return type(like)(*[_unflatten(value, leaves) for value in like])
+    return type(like)(next(leaves))
+
+
+def forward_batch(arg, tangents, outputs, flags=_dr.ADFlag.Default):
+    '''
+    Forward-propagate several tangent directions with a single traversal.
+
+    Evaluating :py:func:`drjit.forward` once per direction traverses the AD
+    graph ``len(tangents)`` times, e.g., when computing the columns of a
+    Jacobian. This function instead visits every edge once and propagates all
+    directions along it. The gradients of the involved variables are not
+    modified. Custom operations (:py:class:`drjit.CustomOp`) are not
+    supported.
+
+    .. code-block::
+
+        x = dr.llvm.ad.Array2f(1, 2)
+        dr.enable_grad(x)
+        y = f(x)
+        dy_dx0, dy_dx1 = dr.forward_batch(x, [(1, 0), (0, 1)], y)
+
+    Args:
+        arg (object): A Dr.Jit differentiable array instance (e.g.,
+          :py:class:`drjit.llvm.ad.Array3f`).
+
+        tangents (list): A list of tangents that are broadcast to the type of
+          ``arg``.
+
+        outputs (object): A Dr.Jit differentiable array instance that depends
+          on ``arg``.
+
+        flags (ADFlag | int): flags to control what should and should not be
+          destructed during the traversal. The default value is
+          ``ADFlag.Default``.
+
+    Returns:
+        list: The tangent of ``outputs`` for each entry of ``tangents``.
+    '''
+    ta, to = type(arg), type(outputs)
+    _check_grad_enabled('forward_batch', ta, arg)
+    if not _dr.is_diff_v(to) or _dr.leaf_array_t(to) is not _dr.leaf_array_t(ta):
+        raise TypeError('forward_batch(): \'outputs\' must be a differentiable '
+                        'array with the same leaf type as \'arg\'!')
+    if _dr.is_tensor_v(ta) or _dr.is_tensor_v(to):
+        raise TypeError('forward_batch(): tensors are not supported!')
+
+    k = len(tangents)
+    inputs = _leaves(arg)
+    values = [_leaves(_dr.detach(ta(t))) for t in tangents]
+    values = [values[j][i] for i in range(len(inputs)) for j in range(k)]
+
+    out_leaves = _leaves(outputs)
+    result = _dr.leaf_array_t(ta).forward_batch_(
+        k, [v.index_ad for v in inputs], values,
+        [v.index_ad for v in out_leaves], flags)
+
+    return [to(_unflatten(_dr.detach(outputs),
+                          iter(result[j::k]))) for j in range(k)]
+
+
 # -------------------------------------------------------------------
 #                      Initialization operations
 # -------------------------------------------------------------------
@@ -5628,6 +5848,102 @@ def custom(cls, *args, **kwargs):
     return output
 
 
+class _Checkpoint(CustomOp):
+    def eval(self, func, args):
+        self.func = func
+        self.args = args # Detached copies, needed to recompute 'func'
+        return func(*args)
+
+    def _recompute(self):
+        # Re-evaluate the function, this creates a temporary AD graph
+        args = _dr.detach(self.args)
+        _dr.enable_grad(args)
+        return args, self.func(*args)
+
+    def forward(self):
+        args, output = self._recompute()
+        _dr.set_grad(args, self.grad_in('args'))
+        _dr.enqueue(_dr.ADMode.Forward, args)
+        traverse(output, _dr.ADMode.Forward)
+        self.set_grad_out(_dr.grad(output))
+
+    def backward(self):
+        args, output = self._recompute()
+        _dr.set_grad(output, self.grad_out())
+        _dr.enqueue(_dr.ADMode.Backward, output)
+        traverse(output, _dr.ADMode.Backward)
+        self.set_grad_in('args', _dr.grad(args))
+
+    def name(self):
+        return "checkpoint"
+
+
+def checkpoint(func, *args):
+    '''
+    Evaluate ``func(*args)`` without recording its AD graph.
+
+    The function is evaluated like a :py:class:`CustomOp`, which only stores
+    the inputs and a single edge in the AD graph. When derivatives are
+    propagated through this edge, ``func`` is evaluated a second time with AD
+    enabled, and the resulting temporary graph is traversed and discarded.
+    This trades computation for memory. See :py:func:`checkpoint_sequential`
+    for a way to bound the peak memory usage of a long computation.
+
+    ``func`` must be a pure function of its arguments and may not access other
+    differentiable variables.
+
+    Args:
+        func (Callable): the function to evaluate
+
+        *args (tuple): the function arguments (Dr.Jit arrays, :ref:`custom
+          data structures <custom-struct>`, sequences, or mappings)
+
+    Returns:
+        object: the return value of ``func``
+    '''
+    return custom(_Checkpoint, func, args)
+
+
+def checkpoint_sequential(funcs, arg, segments):
+    '''
+    Evaluate a sequence of functions ``funcs`` applied to ``arg`` in
+    ``segments`` checkpointed segments.
+
+    This is equivalent to ``funcs[-1](...funcs[1](funcs[0](arg)))``. The
+    functions are split into ``segments`` consecutive groups that are each
+    evaluated using :py:func:`checkpoint`. Only the values at segment
+    boundaries are kept until the AD traversal, and the graph of a single
+    segment is rematerialized at a time. The number of segments thus controls
+    the peak memory usage: a good choice for ``n`` functions of similar cost is
+    ``segments ≈ sqrt(n)``.
+
+    Args:
+        funcs (Sequence[Callable]): functions taking and returning a single value
+
+        arg (object): the input of the first function
+
+        segments (int): number of checkpointed segments
+
+    Returns:
+        object: the return value of the last function
+    '''
+    n = len(funcs)
+    segments = max(1, min(int(segments), n))
+
+    def run_segment(funcs):
+        def run(x):
+            for f in funcs:
+                x = f(x)
+            return x
+        return run
+
+    for i in range(segments):
+        start, end = (i * n) // segments, ((i + 1) * n) // segments
+        arg = checkpoint(run_segment(funcs[start:end]), arg)
+
+    return arg
+
+
 def wrap_ad(source: str, target: str):
     '''
     Function decorator that wraps the excecution of a function using a different
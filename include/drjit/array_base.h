@@ -694,6 +694,61 @@ template <typename Value_, bool IsMask_, typename Derived_> struct ArrayBase {
         }
     }
 
+    Derived prefix_sum_(bool exclusive) const {
+        if constexpr (IsArithmetic) {
+            Derived result;
+            if constexpr (Derived::Size == Dynamic)
+                result = drjit::empty<Derived>(derived().size());
+
+            Value accum = zeros<Value>();
+            for (size_t i = 0; i < derived().size(); ++i) {
+                Value value = derived().entry(i);
+                if (exclusive) {
+                    result.entry(i) = accum;
+                    accum += value;
+                } else {
+                    accum += value;
+                    result.entry(i) = accum;
+                }
+            }
+            return result;
+        } else {
+            drjit_raise("prefix_sum_(): invalid operand type!");
+        }
+    }
+
+    template <typename Mask>
+    Derived segmented_prefix_sum_(const Mask &head, bool exclusive) const {
+        if constexpr (IsArithmetic) {
+            size_t sa = derived().size(), sb = head.size();
+            if constexpr (Derived::Size == Dynamic) {
+                if (sa != sb && sb != 1)
+                    drjit_raise("segmented_prefix_sum_(): mismatched input "
+                                "sizes (%zu and %zu)", sa, sb);
+            }
+
+            Derived result;
+            if constexpr (Derived::Size == Dynamic)
+                result = drjit::empty<Derived>(sa);
+
+            Value accum = zeros<Value>();
+            for (size_t i = 0; i < sa; ++i) {
+                Value value = derived().entry(i);
+                accum = select(head.entry(sb == 1 ? 0 : i), zeros<Value>(), accum);
+                if (exclusive) {
+                    result.entry(i) = accum;
+                    accum += value;
+                } else {
+                    accum += value;
+                    result.entry(i) = accum;
+                }
+            }
+            return result;
+        } else {
+            drjit_raise("segmented_prefix_sum_(): invalid operand type!");
+        }
+    }
+
     mask_t<Value> all_() const {
         if constexpr (IsMask) {
             if constexpr (Derived::Size == Dynamic) {
@@ -756,6 +811,20 @@ template <typename Value_, bool IsMask_, typename Derived_> struct ArrayBase {
         return zeros<Value>();
     }
 
+    template <typename Mask, enable_if_t<Mask::Depth == 1> = 0>
+    size_t compress_store_(void *ptr, const Mask &mask) const {
+        Value *out = (Value *) ptr;
+        size_t count = 0;
+
+        for (size_t i = 0; i < derived().size(); ++i) {
+            bool m = mask.entry(i);
+            if (m)
+                out[count++] = derived().entry(i);
+        }
+
+        return count;
+    }
+
     //! @}
     // -----------------------------------------------------------------------
 
@@ -119,6 +119,16 @@ struct StaticArrayImpl<Value_, Size_, IsMask_, Derived_,
         }
     }
 
+#if defined(DRJIT_X86_F16C)
+    /// Vectorized conversion of a single precision packet to half precision
+    template <typename Derived2, typename T = Value_,
+              enable_if_t<std::is_same_v<T, half> && !IsMask_ &&
+                          Derived2::IsPacked> = 0>
+    StaticArrayImpl(const StaticArrayBase<float, Size_, false, Derived2> &v) {
+        v.derived().store_half_(m_data);
+    }
+#endif
+
 #if defined(NDEBUG)
     StaticArrayImpl() = default;
 #else
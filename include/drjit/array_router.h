@@ -608,12 +608,62 @@ value_t<Array> extract(const Array &array, const Mask &mask) {
     return array.extract_(mask);
 }
 
+/**
+ * \brief Store the entries of \c value whose \c mask bit is set contiguously
+ * to \c ptr, and return the number of entries written.
+ *
+ * Packet implementations may write a full packet (including padding lanes)
+ * to \c ptr, hence the destination must have room for it. Entries beyond the
+ * returned count have unspecified values.
+ */
+template <typename Array, typename Mask>
+size_t compress_store(void *ptr, const Array &value, const Mask &mask) {
+    if constexpr (is_array_v<Array>) {
+        return value.compress_store_(ptr, mask);
+    } else {
+        if (mask)
+            *(Array *) ptr = value;
+        return mask ? 1 : 0;
+    }
+}
+
 template <typename Mask>
 uint32_array_t<array_t<Mask>> compress(const Mask &mask) {
     static_assert(is_dynamic_array_v<Mask>);
     return mask.compress_();
 }
 
+/**
+ * \brief Compute an inclusive (default) or exclusive prefix sum of the
+ * entries of \c value along its outermost dimension
+ */
+template <typename Array>
+Array prefix_sum(const Array &value, bool exclusive = false) {
+    static_assert(!is_diff_v<Array> || array_depth_v<Array> > 1,
+                  "prefix_sum(): differentiable arrays are not supported, "
+                  "detach() the input first!");
+    if constexpr (is_array_v<Array>)
+        return value.prefix_sum_(exclusive);
+    else
+        return exclusive ? Array(0) : value;
+}
+
+/**
+ * \brief Segmented variant of \ref prefix_sum(). The running sum restarts at
+ * every entry where \c head is \c true.
+ */
+template <typename Array>
+Array segmented_prefix_sum(const Array &value, const mask_t<Array> &head,
+                           bool exclusive = false) {
+    static_assert(!is_diff_v<Array> || array_depth_v<Array> > 1,
+                  "segmented_prefix_sum(): differentiable arrays are not "
+                  "supported, detach() the input first!");
+    if constexpr (is_array_v<Array>)
+        return value.segmented_prefix_sum_(head, exclusive);
+    else
+        return exclusive ? Array(0) : value;
+}
+
 //! @}
 // -----------------------------------------------------------------------
 
@@ -1144,7 +1194,7 @@ void scatter_reduce(ReduceOp op, Target &&target, const Value &value,
                 else if (op == ReduceOp::Max)
                     return maximum(a, b);
 
-                if constexpr (std::is_same_v<Value, bool>) {
+                if constexpr (std::is_integral_v<Value>) {
                     if (op == ReduceOp::And)
                         return a & b;
                     else if (op == ReduceOp::Or)
@@ -1878,7 +1928,23 @@ enum class ADFlag : uint32_t {
    ClearVertices = (uint32_t) ClearInput | (uint32_t) ClearInterior,
 
    /// Default: clear everything (edges, gradients of processed vertices)
-   Default = (uint32_t) ClearEdges | (uint32_t) ClearVertices
+   Default = (uint32_t) ClearEdges | (uint32_t) ClearVertices,
+
+   /**
+    * Process independent edges of each topological level of the graph in
+    * parallel. Gradients are accumulated in an order that does not depend on
+    * the number of threads. Only affects the scalar AD variants; the JIT
+    * variants always traverse serially.
+    */
+   Parallel = 8,
+
+   /**
+    * Defer the backward scatters of gathers (JIT variants with
+    * JitFlag::ADOptimize), so that gathers from the same source that share
+    * their offsets and mask perform a single combined scatter. Gathers that
+    * only access a small part of a large array are always deferred.
+    */
+   CombineGathers = 16
 };
 
 constexpr uint32_t operator |(ADFlag f1, ADFlag f2)   { return (uint32_t) f1 | (uint32_t) f2; }
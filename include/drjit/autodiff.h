@@ -57,12 +57,82 @@ void ad_set_grad(uint32_t index, const Value &v, bool fail_if_missing);
 template <typename Value>
 void ad_accum_grad(uint32_t index, const Value &v, bool fail_if_missing);
 
+/**
+ * \brief Query the gradient of a variable as a list of (offset, value) pairs
+ *
+ * Gathers that only access a small part of a large variable (or all gathers,
+ * when traversing with ADFlag::CombineGathers) record the gradient of the
+ * source variable in sparse form, which ad_grad() converts into a dense
+ * array. This function instead returns the gradient as it is stored: values
+ * whose offsets coincide must be added. A dense gradient is returned with
+ * offsets <tt>arange(size)</tt>.
+ */
+template <typename Value, typename Index>
+void ad_grad_sparse(uint32_t index, Index &offsets, Value &values);
+
+/// Add the gradient of a variable to 'target' without converting it into a dense array
+template <typename Value> void ad_accum_grad_into(uint32_t index, Value &target);
+
 /// Enqueue a variable for a subsequent ad_traverse() command
 template <typename Value> void ad_enqueue(ADMode mode, uint32_t index);
 
 /// Propagate derivatives through the enqueued set of edges
 template <typename Value> void ad_traverse(ADMode mode, uint32_t flags);
 
+/**
+ * \brief Forward-propagate 'k' tangent directions in a single traversal
+ *
+ * Computing a Jacobian with 'k' columns using ad_traverse() requires 'k'
+ * separate traversals. This function instead visits each edge once and
+ * propagates all directions along it.
+ *
+ * 'tangents' holds 'k' tangents for each of the 'n_in' input variables
+ * 'in' (entry 'i * k + j' is direction 'j' of input 'i'). On return,
+ * 'out_tangents' holds the corresponding tangents of the 'n_out' output
+ * variables 'out' using the same layout. The 'grad' field of the variables
+ * is left untouched. Custom operations are not supported.
+ */
+template <typename Value>
+void ad_forward_batch(size_t k, size_t n_in, const uint32_t *in,
+                      const Value *tangents, size_t n_out, const uint32_t *out,
+                      Value *out_tangents, uint32_t flags);
+
+/**
+ * \brief Create a tape that captures the traversal schedule of an AD graph
+ *
+ * Optimization loops often construct a graph with the same structure in every
+ * iteration. A tape lets the AD backend reuse the ordered edge list computed
+ * by ad_enqueue() and ad_traverse() in the first iteration, which skips the
+ * graph search and sorting steps in subsequent ones. Usage:
+ *
+ * 1. Call ad_tape_begin() before constructing the graph.
+ * 2. The first time, enqueue and traverse as usual: the traversal is captured.
+ *    Afterwards, set the gradients of the outputs and call ad_tape_replay().
+ * 3. Call ad_tape_end().
+ *
+ * Returns an ID that must be released using ad_tape_free().
+ */
+template <typename Value> uint32_t ad_tape_new();
+
+/// Release a tape created by ad_tape_new()
+template <typename Value> void ad_tape_free(uint32_t tape);
+
+/// Let the tape track the graph construction performed by the calling thread
+template <typename Value> void ad_tape_begin(uint32_t tape);
+
+/// Stop tracking graph construction (see ad_tape_begin())
+template <typename Value> void ad_tape_end();
+
+/// Has the tape already captured a traversal?
+template <typename Value> bool ad_tape_recorded(uint32_t tape);
+
+/**
+ * \brief Propagate derivatives along the schedule captured by the active tape
+ *
+ * Raises an exception if the graph differs from the captured one.
+ */
+template <typename Value> void ad_tape_replay(uint32_t flags);
+
 /// Number of observed implicit dependencies
 template <typename Value> size_t ad_implicit();
 
@@ -1814,8 +1884,19 @@ protected:
                                                          const char *);        \
     extern template DRJIT_AD_EXPORT const char *ad_label<T>(uint32_t);         \
     extern template DRJIT_AD_EXPORT const char *ad_graphviz<T>();              \
+    extern template DRJIT_AD_EXPORT void ad_grad_sparse<T, Index>(uint32_t,    \
+                                                               Index &, T &);  \
+    extern template DRJIT_AD_EXPORT void ad_accum_grad_into<T>(uint32_t, T &); \
     extern template DRJIT_AD_EXPORT void ad_enqueue<T>(ADMode, uint32_t);      \
     extern template DRJIT_AD_EXPORT void ad_traverse<T>(ADMode, uint32_t);     \
+    extern template DRJIT_AD_EXPORT void ad_forward_batch<T>(size_t, size_t,   \
+        const uint32_t *, const T *, size_t, const uint32_t *, T *, uint32_t); \
+    extern template DRJIT_AD_EXPORT uint32_t ad_tape_new<T>();                 \
+    extern template DRJIT_AD_EXPORT void ad_tape_free<T>(uint32_t);            \
+    extern template DRJIT_AD_EXPORT void ad_tape_begin<T>(uint32_t);           \
+    extern template DRJIT_AD_EXPORT void ad_tape_end<T>();                     \
+    extern template DRJIT_AD_EXPORT bool ad_tape_recorded<T>(uint32_t);        \
+    extern template DRJIT_AD_EXPORT void ad_tape_replay<T>(uint32_t);          \
     extern template DRJIT_AD_EXPORT uint32_t ad_new_select<T, Mask>(           \
         const char *, size_t, const Mask &, uint32_t, uint32_t);               \
     extern template DRJIT_AD_EXPORT uint32_t ad_new_gather<T, Mask, Index>(    \
@@ -1846,9 +1927,44 @@ DRJIT_DECLARE_EXTERN_TEMPLATE(LLVMArray<double>, LLVMArray<bool>, LLVMArray<uint
 #endif
 
 extern DRJIT_AD_EXPORT const char *ad_whos();
+
+/// Return AD statistics accumulated over all graph shards and AD variants
+extern DRJIT_AD_EXPORT ADStats ad_stats();
+
+/// Reset the counters reported by \ref ad_stats()
+extern DRJIT_AD_EXPORT void ad_stats_reset();
+
 extern DRJIT_AD_EXPORT void ad_prefix_push(const char *value);
 extern DRJIT_AD_EXPORT void ad_prefix_pop();
 
+/**
+ * \brief Should AD variables created by the calling thread be stored in a
+ * separate, thread-local graph?
+ *
+ * By default, all threads share a single AD graph protected by a global lock.
+ * When this flag is set, variables without differentiable operands (i.e., the
+ * roots of a new computation) are instead created in a graph owned by the
+ * calling thread, and all dependent variables follow. Graph modification and
+ * traversal then no longer contend with other threads. Variables belonging to
+ * different thread-local graphs may not be combined.
+ */
+extern DRJIT_AD_EXPORT void ad_set_thread_local(bool value);
+
+/// Return whether the calling thread uses a thread-local AD graph
+extern DRJIT_AD_EXPORT bool ad_thread_local();
+
+/**
+ * \brief Install hooks that run before and after a thread blocks on the lock
+ * of an AD graph that is held by another thread
+ *
+ * The value returned by \c begin is passed to \c end. The Python bindings
+ * use this to release the GIL while waiting, since the thread holding the
+ * lock may need it to run a \c CustomOp callback. Pass \c nullptr to remove
+ * the hooks.
+ */
+extern DRJIT_AD_EXPORT void ad_set_wait_hooks(void *(*begin)(),
+                                              void (*end)(void *));
+
 NAMESPACE_END(drjit)
 
 #if defined(DRJIT_VCALL_H)
@@ -343,4 +343,88 @@ template <typename Custom, typename... Input> auto custom(const Input&... input)
     return output;
 }
 
+NAMESPACE_BEGIN(detail)
+
+template <typename DiffType, typename Output, typename Func, typename... Args>
+struct Checkpoint : CustomOp<DiffType, Output, Func, Args...> {
+    using Base = CustomOp<DiffType, Output, Func, Args...>;
+
+    // The primal inputs are needed to recompute the function
+    static constexpr bool ClearPrimal = false;
+
+    Output eval(const Func &func, const Args &... args) override {
+        return func(args...);
+    }
+
+    void forward() override {
+        forward_impl(std::make_index_sequence<sizeof...(Args)>());
+    }
+
+    void backward() override {
+        backward_impl(std::make_index_sequence<sizeof...(Args)>());
+    }
+
+    const char *name() const override { return "checkpoint"; }
+
+private:
+    template <size_t... Is> void forward_impl(std::index_sequence<Is...>) {
+        const Func &func = Base::template value_in<0>();
+        dr_tuple<Args...> args(Base::template value_in<1 + Is>()...);
+        enable_grad(args.template get<Is>()...);
+
+        // Recompute the function, this creates a temporary AD graph
+        Output output = func(args.template get<Is>()...);
+
+        (set_grad(args.template get<Is>(), Base::template grad_in<1 + Is>()), ...);
+        enqueue(ADMode::Forward, args.template get<Is>()...);
+        traverse<DiffType>(ADMode::Forward);
+
+        Base::set_grad_out(grad<false>(output));
+    }
+
+    template <size_t... Is> void backward_impl(std::index_sequence<Is...>) {
+        const Func &func = Base::template value_in<0>();
+        dr_tuple<Args...> args(Base::template value_in<1 + Is>()...);
+        enable_grad(args.template get<Is>()...);
+
+        // Recompute the function, this creates a temporary AD graph
+        Output output = func(args.template get<Is>()...);
+
+        set_grad(output, Base::grad_out());
+        enqueue(ADMode::Backward, output);
+        traverse<DiffType>(ADMode::Backward);
+
+        (Base::template set_grad_in<1 + Is>(grad<false>(args.template get<Is>())), ...);
+    }
+};
+
+NAMESPACE_END(detail)
+
+/**
+ * \brief Evaluate 'func(args...)' without recording its AD graph
+ *
+ * The function is evaluated like a CustomOp, which only stores the inputs and
+ * a single edge in the AD graph. When derivatives are propagated through this
+ * edge, the function is evaluated a second time with AD enabled and the
+ * resulting temporary graph is traversed and discarded. This trades
+ * computation for memory: applying checkpoint() to consecutive segments of a
+ * long computation bounds the peak memory usage by the graph of the largest
+ * segment.
+ *
+ * 'func' must be a pure function of its arguments and may not access other
+ * differentiable variables.
+ */
+template <typename Func, typename... Args>
+auto checkpoint(const Func &func, const Args &... args) {
+    using Output = std::decay_t<decltype(func(args...))>;
+    using DiffType = leaf_array_t<Output, Args...>;
+
+    if constexpr (is_diff_v<DiffType> &&
+                  std::is_floating_point_v<scalar_t<DiffType>>)
+        return custom<detail::Checkpoint<DiffType, Output, Func, Args...>>(
+            func, args...);
+    else
+        return func(args...);
+}
+
 NAMESPACE_END(drjit)
@@ -14,6 +14,7 @@
 #pragma once
 
 #include <drjit/array.h>
+#include <drjit/scan.h>
 
 NAMESPACE_BEGIN(drjit)
 
@@ -216,6 +217,48 @@ struct DynamicArray
         }
     }
 
+    DynamicArray prefix_sum_(bool exclusive) const {
+        if constexpr (!std::is_arithmetic_v<Value> || IsMask) {
+            return Base::prefix_sum_(exclusive);
+        } else {
+            DynamicArray result;
+            result.init_(m_size);
+            prefix_sum(m_data, result.m_data, m_size, exclusive);
+            return result;
+        }
+    }
+
+    template <typename Mask>
+    DynamicArray segmented_prefix_sum_(const Mask &head, bool exclusive) const {
+        if constexpr (!std::is_arithmetic_v<Value> || IsMask) {
+            return Base::segmented_prefix_sum_(head, exclusive);
+        } else {
+            size_t n_head = head.size();
+            if (m_size != n_head && n_head != 1)
+                drjit_raise("segmented_prefix_sum(): mismatched input sizes "
+                            "(%zu and %zu)", m_size, n_head);
+
+            DynamicArray result;
+            result.init_(m_size);
+
+            Value accum = Value(0);
+            for (size_t i = 0; i < m_size; ++i) {
+                Value value = m_data[i];
+                if (head.m_data[n_head == 1 ? 0 : i])
+                    accum = Value(0);
+                if (exclusive) {
+                    result.m_data[i] = accum;
+                    accum += value;
+                } else {
+                    accum += value;
+                    result.m_data[i] = accum;
+                }
+            }
+
+            return result;
+        }
+    }
+
     void init_(size_t size) {
         if (size == 0)
             return;
@@ -274,6 +274,42 @@ namespace detail {
 /// This library supports two main directions of derivative propagation
 enum class ADMode { Primal, Forward, Backward };
 
+/// Counters describing the activity of the AD layer, see \ref ad_stats()
+struct ADStats {
+    /// Number of AD variables and edges created since the last reset
+    uint64_t variables_created = 0;
+    uint64_t edges_created = 0;
+
+    /// Number of AD variables and edges that currently exist
+    uint64_t variables_live = 0;
+    uint64_t edges_live = 0;
+
+    /// Maximum number of edges that existed at the same time (summed over graph shards)
+    uint64_t edges_peak = 0;
+
+    /// Number of special edges created since the last reset, by type
+    uint64_t gather_edges = 0;
+    uint64_t scatter_edges = 0;
+    uint64_t mask_edges = 0;
+    uint64_t callback_edges = 0;
+
+    /// Number of ad_traverse() calls and edges traversed by them
+    uint64_t traversals = 0;
+    uint64_t edges_traversed = 0;
+
+    /// Time spent in ad_traverse() in seconds (nested traversals count twice)
+    double traverse_time = 0.0;
+
+    /// Time spent bringing the edges into traversal order (in seconds)
+    double sort_time = 0.0;
+
+    /// Number of times a thread had to wait for the lock of a graph shard
+    uint64_t lock_contentions = 0;
+
+    /// Total time spent waiting for locks (in seconds)
+    double lock_wait_time = 0.0;
+};
+
 NAMESPACE_BEGIN(detail)
 enum class ADScope { Invalid = 0, Suspend = 1, Resume = 2, Isolate = 3 };
 // A few forward declarations so that this compiles even without autodiff.h
@@ -13,7 +13,7 @@
 
 #pragma once
 
-#include <drjit/array_traits.h>
+#include <drjit/array_constants.h>
 #include <drjit/packet_intrin.h>
 
 NAMESPACE_BEGIN(drjit)
@@ -30,11 +30,11 @@ NAMESPACE_BEGIN(drjit)
 struct half {
     uint16_t value;
 
-    half()
-    #if !defined(NDEBUG)
-        : value(0x7FFF) /* Initialize with NaN */
-    #endif
-    { }
+#if !defined(NDEBUG)
+    constexpr half() : value(0x7FFF) /* Initialize with NaN */ { }
+#else
+    half() = default;
+#endif
 
     #define DRJIT_IF_SCALAR template <typename Value, enable_if_t<std::is_arithmetic_v<Value>> = 0>
 
@@ -66,7 +66,11 @@ struct half {
 
     DRJIT_IF_SCALAR operator Value() const { return Value(float16_to_float32(value)); }
 
-    static half from_binary(uint16_t value) { half h; h.value = value; return h; }
+    static constexpr half from_binary(uint16_t value) {
+        half h { };
+        h.value = value;
+        return h;
+    }
 
     friend std::ostream &operator<<(std::ostream &os, const half &h) {
         os << float(h);
@@ -158,6 +162,12 @@ public:
     }
 };
 
+NAMESPACE_BEGIN(detail)
+template <> struct debug_initialization<half> {
+    static constexpr half value = half::from_binary(0x7FFF);
+};
+NAMESPACE_END(detail)
+
 NAMESPACE_END(drjit)
 
 NAMESPACE_BEGIN(std)
@@ -566,6 +566,78 @@ struct JitArray : ArrayBase<Value_, is_mask_v<Value_>, Derived_> {
         return output;
     }
 
+    Derived prefix_sum_(bool exclusive) const {
+        if constexpr (Backend != JitBackend::LLVM || !Base::IsArithmetic) {
+            drjit_raise("prefix_sum(): only arithmetic arrays of the LLVM "
+                        "backend are supported!");
+        } else {
+            size_t n = size();
+            Derived output = empty_(n);
+            if (n == 0)
+                return output;
+
+            const Value *in = data();
+            Value *out = output.data();
+
+            // Wait for the input and the output allocation to be ready
+            jit_sync_thread();
+
+            Value accum = Value(0);
+            for (size_t i = 0; i < n; ++i) {
+                Value value = in[i];
+                if (exclusive) {
+                    out[i] = accum;
+                    accum += value;
+                } else {
+                    accum += value;
+                    out[i] = accum;
+                }
+            }
+
+            return output;
+        }
+    }
+
+    template <typename Mask>
+    Derived segmented_prefix_sum_(const Mask &head, bool exclusive) const {
+        if constexpr (Backend != JitBackend::LLVM || !Base::IsArithmetic) {
+            drjit_raise("segmented_prefix_sum(): only arithmetic arrays of "
+                        "the LLVM backend are supported!");
+        } else {
+            size_t n = size(), n_head = head.size();
+            if (n != n_head && n_head != 1)
+                drjit_raise("segmented_prefix_sum(): mismatched input sizes "
+                            "(%zu and %zu)", n, n_head);
+
+            Derived output = empty_(n);
+            if (n == 0)
+                return output;
+
+            const Value *in = data();
+            const bool *head_p = head.data();
+            Value *out = output.data();
+
+            // Wait for the inputs and the output allocation to be ready
+            jit_sync_thread();
+
+            Value accum = Value(0);
+            for (size_t i = 0; i < n; ++i) {
+                Value value = in[i];
+                if (head_p[n_head == 1 ? 0 : i])
+                    accum = Value(0);
+                if (exclusive) {
+                    out[i] = accum;
+                    accum += value;
+                } else {
+                    accum += value;
+                    out[i] = accum;
+                }
+            }
+
+            return output;
+        }
+    }
+
     Derived copy() const { return steal(jit_var_copy(m_index)); }
 
     bool schedule_() const { return jit_var_schedule(m_index) != 0; }
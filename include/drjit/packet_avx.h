@@ -40,10 +40,10 @@ template <bool IsMask_, typename Derived_> struct alignas(32)
     //! @{ \name Type converting constructors
     // -----------------------------------------------------------------------
 
-// #if defined(DRJIT_X86_F16C)
-//     DRJIT_CONVERT(half)
-//         : m(_mm256_cvtph_ps(_mm_loadu_si128((const __m128i *) a.derived().data()))) { }
-// #endif
+#if defined(DRJIT_X86_F16C)
+    DRJIT_CONVERT_HALF
+        : m(_mm256_cvtph_ps(_mm_loadu_si128((const __m128i *) a.derived().data()))) { }
+#endif
 
     DRJIT_CONVERT(float) : m(a.derived().m) { }
 
@@ -381,6 +381,29 @@ template <bool IsMask_, typename Derived_> struct alignas(32)
         return _mm_cvtss_f32(mr);
     }
 
+    DRJIT_INLINE Derived prefix_sum_(bool exclusive) const {
+        __m256 zero = _mm256_setzero_ps();
+
+        // In-lane scan, shifting by one and two elements within each 128-bit lane
+        __m256 r = _mm256_add_ps(m, _mm256_blend_ps(
+            _mm256_permute_ps(m, _MM_SHUFFLE(2, 1, 0, 3)), zero, 0x11));
+        r = _mm256_add_ps(r, _mm256_blend_ps(
+            _mm256_permute_ps(r, _MM_SHUFFLE(1, 0, 3, 2)), zero, 0x33));
+
+        // Propagate the total of the low lane into the high lane
+        __m256 lo = _mm256_permute2f128_ps(r, r, 0x08);
+        r = _mm256_add_ps(r, _mm256_permute_ps(lo, _MM_SHUFFLE(3, 3, 3, 3)));
+
+        if (exclusive) {
+            lo = _mm256_permute2f128_ps(r, r, 0x08);
+            r = _mm256_blend_ps(_mm256_permute_ps(r, _MM_SHUFFLE(2, 1, 0, 3)),
+                                _mm256_permute_ps(lo, _MM_SHUFFLE(2, 1, 0, 3)),
+                                0x11);
+        }
+
+        return r;
+    }
+
     //! @}
     // -----------------------------------------------------------------------
 
@@ -396,6 +419,32 @@ template <bool IsMask_, typename Derived_> struct alignas(32)
         _mm256_storeu_ps((Value *) ptr, m);
     }
 
+    template <typename Mask>
+    DRJIT_INLINE size_t compress_store_(void *ptr, const Mask &mask) const {
+        uint32_t bits = mask.bitmask_();
+#if defined(DRJIT_X86_AVX512)
+        _mm256_mask_compressstoreu_ps(ptr, (__mmask8) bits, m);
+#elif defined(DRJIT_X86_AVX2)
+        detail::mm256_compress_store_epi32(ptr, _mm256_castps_si256(m), bits);
+#else
+        uint32_t lo = bits & 0xF;
+        detail::mm_compress_store_epi32(
+            ptr, _mm_castps_si128(_mm256_castps256_ps128(m)), lo);
+        detail::mm_compress_store_epi32(
+            (Value *) ptr + _mm_popcnt_u32(lo),
+            _mm_castps_si128(_mm256_extractf128_ps(m, 1)), bits >> 4);
+#endif
+        return (size_t) _mm_popcnt_u32(bits);
+    }
+
+#if defined(DRJIT_X86_F16C)
+    /// Convert to half precision and store the result (used by Array<half, 8>)
+    DRJIT_INLINE void store_half_(void *ptr) const {
+        _mm_storeu_si128((__m128i *) ptr,
+                         _mm256_cvtps_ph(m, _MM_FROUND_CUR_DIRECTION));
+    }
+#endif
+
     static DRJIT_INLINE Derived load_aligned_(const void *ptr, size_t) {
         return _mm256_load_ps((const Value *) DRJIT_ASSUME_ALIGNED(ptr, 32));
     }
@@ -464,12 +513,12 @@ template <bool IsMask_, typename Derived_> struct alignas(32)
     //! @{ \name Type converting constructors
     // -----------------------------------------------------------------------
 
-// #if defined(DRJIT_X86_F16C)
-//     DRJIT_CONVERT(half) {
-//         m = _mm256_cvtps_pd(
-//             _mm_cvtph_ps(_mm_loadl_epi64((const __m128i *) a.derived().data())));
-//     }
-// #endif
+#if defined(DRJIT_X86_F16C)
+    DRJIT_CONVERT_HALF {
+        m = _mm256_cvtps_pd(
+            _mm_cvtph_ps(_mm_loadl_epi64((const __m128i *) a.derived().data())));
+    }
+#endif
 
     DRJIT_CONVERT(float) : m(_mm256_cvtps_pd(a.derived().m)) { }
     DRJIT_CONVERT(int32_t) : m(_mm256_cvtepi32_pd(a.derived().m)) { }
@@ -761,6 +810,27 @@ template <bool IsMask_, typename Derived_> struct alignas(32)
         _mm256_storeu_pd((Value *) ptr, m);
     }
 
+    template <typename Mask>
+    DRJIT_INLINE size_t compress_store_(void *ptr, const Mask &mask) const {
+        uint32_t bits = mask.bitmask_();
+#if defined(DRJIT_X86_AVX512)
+        _mm256_mask_compressstoreu_pd(ptr, (__mmask8) bits, m);
+#elif defined(DRJIT_X86_AVX2)
+        detail::mm256_compress_store_epi32(ptr, _mm256_castpd_si256(m),
+                                           detail::compress_mask_64(bits));
+#else
+        uint32_t lo = bits & 3;
+        detail::mm_compress_store_epi32(
+            ptr, _mm_castpd_si128(_mm256_castpd256_pd128(m)),
+            detail::compress_mask_64(lo));
+        detail::mm_compress_store_epi32(
+            (Value *) ptr + _mm_popcnt_u32(lo),
+            _mm_castpd_si128(_mm256_extractf128_pd(m, 1)),
+            detail::compress_mask_64(bits >> 2));
+#endif
+        return (size_t) _mm_popcnt_u32(bits);
+    }
+
     static DRJIT_INLINE Derived load_aligned_(const void *ptr, size_t) {
         return _mm256_load_pd((const Value *) DRJIT_ASSUME_ALIGNED(ptr, 32));
     }
@@ -810,13 +880,13 @@ template <bool IsMask_, typename Derived_> struct alignas(32)
     DRJIT_PACKET_TYPE_3D(double)
 
 #if defined(DRJIT_X86_F16C)
-    // template <typename Derived2>
-    // DRJIT_INLINE StaticArrayImpl(const StaticArrayBase<half, 3, IsMask_, Derived2> &a) {
-    //     uint16_t temp[4];
-    //     memcpy(temp, a.derived().data(), sizeof(uint16_t) * 3);
-    //     temp[3] = 0;
-    //     m = _mm256_cvtps_pd(_mm_cvtph_ps(_mm_loadl_epi64((const __m128i *) temp)));
-    // }
+    template <typename Derived2>
+    DRJIT_INLINE StaticArrayImpl(const StaticArrayBase<half, 3, IsMask_, Derived2> &a) {
+        uint16_t temp[4];
+        memcpy(temp, a.derived().data(), sizeof(uint16_t) * 3);
+        temp[3] = 0;
+        m = _mm256_cvtps_pd(_mm_cvtph_ps(_mm_loadl_epi64((const __m128i *) temp)));
+    }
 #endif
 
     template <int I0, int I1, int I2>
@@ -362,6 +362,19 @@ template <typename Value_, bool IsMask_, typename Derived_> struct alignas(32)
     DRJIT_INLINE uint32_t bitmask_() const { return (uint32_t) _mm256_movemask_ps(_mm256_castsi256_ps(m)); }
     DRJIT_INLINE size_t count_() const { return (size_t) _mm_popcnt_u32(bitmask_()); }
 
+    DRJIT_INLINE Derived prefix_sum_(bool exclusive) const {
+        // In-lane scan, followed by propagating the low lane total
+        __m256i r = _mm256_add_epi32(m, _mm256_slli_si256(m, 4));
+        r = _mm256_add_epi32(r, _mm256_slli_si256(r, 8));
+        __m256i lo = _mm256_permute2x128_si256(r, r, 0x08);
+        r = _mm256_add_epi32(r, _mm256_shuffle_epi32(lo, 0xFF));
+
+        if (exclusive)
+            r = _mm256_alignr_epi8(r, _mm256_permute2x128_si256(r, r, 0x08), 12);
+
+        return r;
+    }
+
     //! @}
     // -----------------------------------------------------------------------
 
@@ -377,6 +390,17 @@ template <typename Value_, bool IsMask_, typename Derived_> struct alignas(32)
         _mm256_storeu_si256((__m256i *) ptr, m);
     }
 
+    template <typename Mask>
+    DRJIT_INLINE size_t compress_store_(void *ptr, const Mask &mask) const {
+        uint32_t bits = mask.bitmask_();
+#if defined(DRJIT_X86_AVX512)
+        _mm256_mask_compressstoreu_epi32(ptr, (__mmask8) bits, m);
+#else
+        detail::mm256_compress_store_epi32(ptr, m, bits);
+#endif
+        return (size_t) _mm_popcnt_u32(bits);
+    }
+
     static DRJIT_INLINE Derived load_aligned_(const void *ptr, size_t) {
         return _mm256_load_si256((const __m256i *) DRJIT_ASSUME_ALIGNED(ptr, 32));
     }
@@ -830,6 +854,17 @@ template <typename Value_, bool IsMask_, typename Derived_> struct alignas(32)
         _mm256_storeu_si256((__m256i *) ptr, m);
     }
 
+    template <typename Mask>
+    DRJIT_INLINE size_t compress_store_(void *ptr, const Mask &mask) const {
+        uint32_t bits = mask.bitmask_();
+#if defined(DRJIT_X86_AVX512)
+        _mm256_mask_compressstoreu_epi64(ptr, (__mmask8) bits, m);
+#else
+        detail::mm256_compress_store_epi32(ptr, m, detail::compress_mask_64(bits));
+#endif
+        return (size_t) _mm_popcnt_u32(bits);
+    }
+
     static DRJIT_INLINE Derived load_aligned_(const void *ptr ,size_t) {
         return _mm256_load_si256((const __m256i *) DRJIT_ASSUME_ALIGNED(ptr, 32));
     }
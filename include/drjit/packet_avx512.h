@@ -43,8 +43,8 @@ template <bool IsMask_, typename Derived_> struct alignas(64)
     //! @{ \name Type converting constructors
     // -----------------------------------------------------------------------
 
-    // DRJIT_CONVERT(half)
-    //     : m(_mm512_cvtph_ps(_mm256_loadu_si256((const __m256i *) a.derived().data()))) { }
+    DRJIT_CONVERT_HALF
+        : m(_mm512_cvtph_ps(_mm256_loadu_si256((const __m256i *) a.derived().data()))) { }
 
     DRJIT_CONVERT(float) : m(a.derived().m) { }
 
@@ -251,6 +251,20 @@ template <bool IsMask_, typename Derived_> struct alignas(64)
     DRJIT_INLINE Value min_()  const { return min(minimum(low_(), high_())); }
     DRJIT_INLINE Value max_()  const { return max(maximum(low_(), high_())); }
 
+    DRJIT_INLINE Derived prefix_sum_(bool exclusive) const {
+        __m512i z = _mm512_setzero_si512(), x = _mm512_castps_si512(m);
+        __m512 r = _mm512_add_ps(m, _mm512_castsi512_ps(_mm512_alignr_epi32(x, z, 15)));
+        x = _mm512_castps_si512(r);
+        r = _mm512_add_ps(r, _mm512_castsi512_ps(_mm512_alignr_epi32(x, z, 14)));
+        x = _mm512_castps_si512(r);
+        r = _mm512_add_ps(r, _mm512_castsi512_ps(_mm512_alignr_epi32(x, z, 12)));
+        x = _mm512_castps_si512(r);
+        r = _mm512_add_ps(r, _mm512_castsi512_ps(_mm512_alignr_epi32(x, z, 8)));
+        if (exclusive)
+            r = _mm512_castsi512_ps(_mm512_alignr_epi32(_mm512_castps_si512(r), z, 15));
+        return r;
+    }
+
     //! @}
     // -----------------------------------------------------------------------
 
@@ -262,6 +276,18 @@ template <bool IsMask_, typename Derived_> struct alignas(64)
         _mm512_storeu_ps((Value *) ptr, m);
     }
 
+    template <typename Mask>
+    DRJIT_INLINE size_t compress_store_(void *ptr, const Mask &mask) const {
+        _mm512_mask_compressstoreu_ps(ptr, mask.k, m);
+        return (size_t) _mm_popcnt_u32(mask.bitmask_());
+    }
+
+    /// Convert to half precision and store the result (used by Array<half, 16>)
+    DRJIT_INLINE void store_half_(void *ptr) const {
+        _mm256_storeu_si256((__m256i *) ptr,
+                            _mm512_cvtps_ph(m, _MM_FROUND_CUR_DIRECTION));
+    }
+
     static DRJIT_INLINE Derived load_aligned_(const void *ptr, size_t) {
         return _mm512_load_ps((const Value *) DRJIT_ASSUME_ALIGNED(ptr, 64));
     }
@@ -297,10 +323,20 @@ template <bool IsMask_, typename Derived_> struct alignas(64)
     template <typename Index, typename Mask>
     DRJIT_INLINE void scatter_reduce_(ReduceOp op, void *ptr, const Index &index_,
                                       const Mask &active_) const {
-        if (op != ReduceOp::Add)
-            drjit_raise("Packet scatter_reduce only support Add operation!");
+        if (op != ReduceOp::Add && op != ReduceOp::Mul &&
+            op != ReduceOp::Min && op != ReduceOp::Max)
+            drjit_raise("Packet scatter_reduce: unsupported reduction!");
 
         if constexpr (sizeof(scalar_t<Index>) == 4) {
+            auto reduce = [op](__m512 a, __mmask16 mask, __m512 b) {
+                switch (op) {
+                    case ReduceOp::Mul: return _mm512_mask_mul_ps(a, mask, a, b);
+                    case ReduceOp::Min: return _mm512_mask_min_ps(a, mask, a, b);
+                    case ReduceOp::Max: return _mm512_mask_max_ps(a, mask, a, b);
+                    default:            return _mm512_mask_add_ps(a, mask, a, b);
+                }
+            };
+
             __m512i index = index_.m;
             __mmask16 active = active_.k;
             __m512 value = m;
@@ -313,25 +349,27 @@ template <bool IsMask_, typename Derived_> struct alignas(64)
 
             __mmask16 todo = _mm512_test_epi32_mask(conflicts, conflicts);
 
+            /* Combine lanes that target the same address using a reduction
+               tree. Afterwards, the last such lane holds the full result */
             if (DRJIT_UNLIKELY(!_mm512_kortestz(todo, todo))) {
                 __m512i perm_idx = _mm512_sub_epi32(_mm512_set1_epi32(31),
                                                     _mm512_lzcnt_epi32(conflicts)),
                         all_ones = _mm512_set1_epi32(-1);
                 do {
-                    __m512 value_peer = _mm512_maskz_permutexvar_ps(todo, perm_idx, value);
+                    __m512 value_peer = _mm512_permutexvar_ps(perm_idx, value);
                     perm_idx = _mm512_mask_permutexvar_epi32(perm_idx, todo,
                                                              perm_idx, perm_idx);
-                    value = _mm512_add_ps(value, value_peer);
+                    value = reduce(value, todo, value_peer);
                     todo = _mm512_mask_cmp_epi32_mask(active, all_ones, perm_idx,
                                                       _MM_CMPINT_NE);
                 } while (!_mm512_kortestz(todo, todo));
             }
 
-            value = _mm512_add_ps(value, value_orig);
+            value = reduce(value, active, value_orig);
 
             _mm512_mask_i32scatter_ps(ptr, active, index, value, 4);
         } else {
-            scatter_reduce_(ptr, int32_array_t<Index>(index_), op, active_);
+            scatter_reduce_(op, ptr, int32_array_t<Index>(index_), active_);
         }
     }
 
@@ -361,9 +399,9 @@ template <bool IsMask_, typename Derived_> struct alignas(64)
     //! @{ \name Type converting constructors
     // -----------------------------------------------------------------------
 
-    // DRJIT_CONVERT(half)
-    //     : m(_mm512_cvtps_pd(
-    //           _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *) a.derived().data())))) { }
+    DRJIT_CONVERT_HALF
+        : m(_mm512_cvtps_pd(
+              _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *) a.derived().data())))) { }
 
     DRJIT_CONVERT(float) : m(_mm512_cvtps_pd(a.derived().m)) { }
 
@@ -563,6 +601,18 @@ template <bool IsMask_, typename Derived_> struct alignas(64)
     DRJIT_INLINE Value min_()  const { return min(minimum(low_(), high_())); }
     DRJIT_INLINE Value max_()  const { return max(maximum(low_(), high_())); }
 
+    DRJIT_INLINE Derived prefix_sum_(bool exclusive) const {
+        __m512i z = _mm512_setzero_si512(), x = _mm512_castpd_si512(m);
+        __m512d r = _mm512_add_pd(m, _mm512_castsi512_pd(_mm512_alignr_epi64(x, z, 7)));
+        x = _mm512_castpd_si512(r);
+        r = _mm512_add_pd(r, _mm512_castsi512_pd(_mm512_alignr_epi64(x, z, 6)));
+        x = _mm512_castpd_si512(r);
+        r = _mm512_add_pd(r, _mm512_castsi512_pd(_mm512_alignr_epi64(x, z, 4)));
+        if (exclusive)
+            r = _mm512_castsi512_pd(_mm512_alignr_epi64(_mm512_castpd_si512(r), z, 7));
+        return r;
+    }
+
     //! @}
     // -----------------------------------------------------------------------
 
@@ -574,6 +624,12 @@ template <bool IsMask_, typename Derived_> struct alignas(64)
         _mm512_storeu_pd((Value *) ptr, m);
     }
 
+    template <typename Mask>
+    DRJIT_INLINE size_t compress_store_(void *ptr, const Mask &mask) const {
+        _mm512_mask_compressstoreu_pd(ptr, mask.k, m);
+        return (size_t) _mm_popcnt_u32(mask.bitmask_());
+    }
+
     static DRJIT_INLINE Derived load_aligned_(const void *ptr, size_t) {
         return _mm512_load_pd((const Value *) DRJIT_ASSUME_ALIGNED(ptr, 64));
     }
@@ -604,10 +660,20 @@ template <bool IsMask_, typename Derived_> struct alignas(64)
     template <typename Index, typename Mask>
     DRJIT_INLINE void scatter_reduce_(ReduceOp op, void *ptr, const Index &index_,
                                       const Mask &active_) const {
-        if (op != ReduceOp::Add)
-            drjit_raise("Packet scatter_reduce only support Add operation!");
+        if (op != ReduceOp::Add && op != ReduceOp::Mul &&
+            op != ReduceOp::Min && op != ReduceOp::Max)
+            drjit_raise("Packet scatter_reduce: unsupported reduction!");
 
         if constexpr (sizeof(scalar_t<Index>) == 8) {
+            auto reduce = [op](__m512d a, __mmask8 mask, __m512d b) {
+                switch (op) {
+                    case ReduceOp::Mul: return _mm512_mask_mul_pd(a, mask, a, b);
+                    case ReduceOp::Min: return _mm512_mask_min_pd(a, mask, a, b);
+                    case ReduceOp::Max: return _mm512_mask_max_pd(a, mask, a, b);
+                    default:            return _mm512_mask_add_pd(a, mask, a, b);
+                }
+            };
+
             __m512i index = index_.m;
             __mmask8 active = active_.k;
             __m512d value = m;
@@ -620,25 +686,27 @@ template <bool IsMask_, typename Derived_> struct alignas(64)
 
             __mmask8 todo = _mm512_test_epi64_mask(conflicts, conflicts);
 
+            /* Combine lanes that target the same address using a reduction
+               tree. Afterwards, the last such lane holds the full result */
             if (DRJIT_UNLIKELY(!_kortestz_mask8_u8(todo, todo))) {
                 __m512i perm_idx = _mm512_sub_epi64(_mm512_set1_epi64(63),
                                                     _mm512_lzcnt_epi64(conflicts)),
                         all_ones = _mm512_set1_epi64(-1);
                 do {
-                    __m512d value_peer = _mm512_maskz_permutexvar_pd(todo, perm_idx, value);
+                    __m512d value_peer = _mm512_permutexvar_pd(perm_idx, value);
                     perm_idx = _mm512_mask_permutexvar_epi64(perm_idx, todo,
                                                              perm_idx, perm_idx);
-                    value = _mm512_add_pd(value, value_peer);
+                    value = reduce(value, todo, value_peer);
                     todo = _mm512_mask_cmp_epi64_mask(active, all_ones, perm_idx,
                                                       _MM_CMPINT_NE);
                 } while (!_kortestz_mask8_u8(todo, todo));
             }
 
-            value = _mm512_add_pd(value, value_orig);
+            value = reduce(value, active, value_orig);
 
             _mm512_mask_i64scatter_pd(ptr, active, index, value, 8);
         } else {
-            scatter_reduce_(ptr, int64_array_t<Index>(index_), op, active_);
+            scatter_reduce_(op, ptr, int64_array_t<Index>(index_), active_);
         }
     }
 
@@ -856,6 +924,17 @@ template <typename Value_, bool IsMask_, typename Derived_> struct alignas(64)
     DRJIT_INLINE Value min_()  const { return min(minimum(low_(), high_())); }
     DRJIT_INLINE Value max_()  const { return max(maximum(low_(), high_())); }
 
+    DRJIT_INLINE Derived prefix_sum_(bool exclusive) const {
+        __m512i z = _mm512_setzero_si512();
+        __m512i r = _mm512_add_epi32(m, _mm512_alignr_epi32(m, z, 15));
+        r = _mm512_add_epi32(r, _mm512_alignr_epi32(r, z, 14));
+        r = _mm512_add_epi32(r, _mm512_alignr_epi32(r, z, 12));
+        r = _mm512_add_epi32(r, _mm512_alignr_epi32(r, z, 8));
+        if (exclusive)
+            r = _mm512_alignr_epi32(r, z, 15);
+        return r;
+    }
+
     //! @}
     // -----------------------------------------------------------------------
 
@@ -867,6 +946,12 @@ template <typename Value_, bool IsMask_, typename Derived_> struct alignas(64)
         _mm512_storeu_si512((__m512i *) ptr, m);
     }
 
+    template <typename Mask>
+    DRJIT_INLINE size_t compress_store_(void *ptr, const Mask &mask) const {
+        _mm512_mask_compressstoreu_epi32(ptr, mask.k, m);
+        return (size_t) _mm_popcnt_u32(mask.bitmask_());
+    }
+
     static DRJIT_INLINE Derived load_aligned_(const void *ptr, size_t) {
         return _mm512_load_si512((const __m512i *) DRJIT_ASSUME_ALIGNED(ptr, 64));
     }
@@ -902,10 +987,25 @@ template <typename Value_, bool IsMask_, typename Derived_> struct alignas(64)
     template <typename Index, typename Mask>
     DRJIT_INLINE void scatter_reduce_(ReduceOp op, void *ptr, const Index &index_,
                                       const Mask &active_) const {
-        if (op != ReduceOp::Add)
-            drjit_raise("Packet scatter_reduce only support Add operation!");
+        if (op == ReduceOp::None)
+            drjit_raise("Packet scatter_reduce: unsupported reduction!");
 
         if constexpr (sizeof(scalar_t<Index>) == 4) {
+            auto reduce = [op](__m512i a, __mmask16 mask, __m512i b) {
+                switch (op) {
+                    case ReduceOp::Mul: return _mm512_mask_mullo_epi32(a, mask, a, b);
+                    case ReduceOp::Min: return std::is_signed_v<Value>
+                                            ? _mm512_mask_min_epi32(a, mask, a, b)
+                                            : _mm512_mask_min_epu32(a, mask, a, b);
+                    case ReduceOp::Max: return std::is_signed_v<Value>
+                                            ? _mm512_mask_max_epi32(a, mask, a, b)
+                                            : _mm512_mask_max_epu32(a, mask, a, b);
+                    case ReduceOp::And: return _mm512_mask_and_epi32(a, mask, a, b);
+                    case ReduceOp::Or:  return _mm512_mask_or_epi32(a, mask, a, b);
+                    default:            return _mm512_mask_add_epi32(a, mask, a, b);
+                }
+            };
+
             __m512i index = index_.m;
             __mmask16 active = active_.k;
             __m512i value = m;
@@ -918,25 +1018,27 @@ template <typename Value_, bool IsMask_, typename Derived_> struct alignas(64)
 
             __mmask16 todo = _mm512_test_epi32_mask(conflicts, conflicts);
 
+            /* Combine lanes that target the same address using a reduction
+               tree. Afterwards, the last such lane holds the full result */
             if (DRJIT_UNLIKELY(!_mm512_kortestz(todo, todo))) {
                 __m512i perm_idx = _mm512_sub_epi32(_mm512_set1_epi32(31),
                                                     _mm512_lzcnt_epi32(conflicts)),
                         all_ones = _mm512_set1_epi32(-1);
                 do {
-                    __m512i value_peer = _mm512_maskz_permutexvar_epi32(todo, perm_idx, value);
+                    __m512i value_peer = _mm512_permutexvar_epi32(perm_idx, value);
                     perm_idx = _mm512_mask_permutexvar_epi32(perm_idx, todo,
                                                              perm_idx, perm_idx);
-                    value = _mm512_add_epi32(value, value_peer);
+                    value = reduce(value, todo, value_peer);
                     todo = _mm512_mask_cmp_epi32_mask(active, all_ones, perm_idx,
                                                       _MM_CMPINT_NE);
                 } while (!_mm512_kortestz(todo, todo));
             }
 
-            value = _mm512_add_epi32(value, value_orig);
+            value = reduce(value, active, value_orig);
 
             _mm512_mask_i32scatter_epi32(ptr, active, index, value, 4);
         } else {
-            scatter_reduce_(ptr, int32_array_t<Index>(index_), op, active_);
+            scatter_reduce_(op, ptr, int32_array_t<Index>(index_), active_);
         }
     }
 
@@ -1169,6 +1271,16 @@ template <typename Value_, bool IsMask_, typename Derived_> struct alignas(64)
     DRJIT_INLINE Value min_()  const { return min(minimum(low_(), high_())); }
     DRJIT_INLINE Value max_()  const { return max(maximum(low_(), high_())); }
 
+    DRJIT_INLINE Derived prefix_sum_(bool exclusive) const {
+        __m512i z = _mm512_setzero_si512();
+        __m512i r = _mm512_add_epi64(m, _mm512_alignr_epi64(m, z, 7));
+        r = _mm512_add_epi64(r, _mm512_alignr_epi64(r, z, 6));
+        r = _mm512_add_epi64(r, _mm512_alignr_epi64(r, z, 4));
+        if (exclusive)
+            r = _mm512_alignr_epi64(r, z, 7);
+        return r;
+    }
+
     //! @}
     // -----------------------------------------------------------------------
 
@@ -1180,6 +1292,12 @@ template <typename Value_, bool IsMask_, typename Derived_> struct alignas(64)
         _mm512_storeu_si512((__m512i *) ptr, m);
     }
 
+    template <typename Mask>
+    DRJIT_INLINE size_t compress_store_(void *ptr, const Mask &mask) const {
+        _mm512_mask_compressstoreu_epi64(ptr, mask.k, m);
+        return (size_t) _mm_popcnt_u32(mask.bitmask_());
+    }
+
     static DRJIT_INLINE Derived load_aligned_(const void *ptr, size_t) {
         return _mm512_load_si512((const __m512i *) DRJIT_ASSUME_ALIGNED(ptr, 64));
     }
@@ -1211,10 +1329,25 @@ template <typename Value_, bool IsMask_, typename Derived_> struct alignas(64)
     template <typename Index, typename Mask>
     DRJIT_INLINE void scatter_reduce_(ReduceOp op, void *ptr, const Index &index_,
                                       const Mask &active_) const {
-        if (op != ReduceOp::Add)
-            drjit_raise("Packet scatter_reduce only support Add operation!");
+        if (op == ReduceOp::None)
+            drjit_raise("Packet scatter_reduce: unsupported reduction!");
 
         if constexpr (sizeof(scalar_t<Index>) == 8) {
+            auto reduce = [op](__m512i a, __mmask8 mask, __m512i b) {
+                switch (op) {
+                    case ReduceOp::Mul: return _mm512_mask_mullo_epi64(a, mask, a, b);
+                    case ReduceOp::Min: return std::is_signed_v<Value>
+                                            ? _mm512_mask_min_epi64(a, mask, a, b)
+                                            : _mm512_mask_min_epu64(a, mask, a, b);
+                    case ReduceOp::Max: return std::is_signed_v<Value>
+                                            ? _mm512_mask_max_epi64(a, mask, a, b)
+                                            : _mm512_mask_max_epu64(a, mask, a, b);
+                    case ReduceOp::And: return _mm512_mask_and_epi64(a, mask, a, b);
+                    case ReduceOp::Or:  return _mm512_mask_or_epi64(a, mask, a, b);
+                    default:            return _mm512_mask_add_epi64(a, mask, a, b);
+                }
+            };
+
             __m512i index = index_.m;
             __mmask8 active = active_.k;
             __m512i value = m;
@@ -1227,25 +1360,27 @@ template <typename Value_, bool IsMask_, typename Derived_> struct alignas(64)
 
             __mmask8 todo = _mm512_test_epi64_mask(conflicts, conflicts);
 
+            /* Combine lanes that target the same address using a reduction
+               tree. Afterwards, the last such lane holds the full result */
             if (DRJIT_UNLIKELY(!_kortestz_mask8_u8(todo, todo))) {
                 __m512i perm_idx = _mm512_sub_epi64(_mm512_set1_epi64(63),
                                                     _mm512_lzcnt_epi64(conflicts)),
                         all_ones = _mm512_set1_epi64(-1);
                 do {
-                    __m512i value_peer = _mm512_maskz_permutexvar_epi64(todo, perm_idx, value);
+                    __m512i value_peer = _mm512_permutexvar_epi64(perm_idx, value);
                     perm_idx = _mm512_mask_permutexvar_epi64(perm_idx, todo,
                                                              perm_idx, perm_idx);
-                    value = _mm512_add_epi64(value, value_peer);
+                    value = reduce(value, todo, value_peer);
                     todo = _mm512_mask_cmp_epi64_mask(active, all_ones, perm_idx,
                                                       _MM_CMPINT_NE);
                 } while (!_kortestz_mask8_u8(todo, todo));
             }
 
-            value = _mm512_add_epi64(value, value_orig);
+            value = reduce(value, active, value_orig);
 
             _mm512_mask_i64scatter_epi64(ptr, active, index, value, 8);
         } else {
-            scatter_reduce_(ptr, int64_array_t<Index>(index_), op, active_);
+            scatter_reduce_(op, ptr, int64_array_t<Index>(index_), active_);
         }
     }
 
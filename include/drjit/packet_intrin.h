@@ -215,6 +215,72 @@ DRJIT_INLINE __m512i concat(__m256i l, __m256i h) {
 //! @}
 // -----------------------------------------------------------------------
 
+// -----------------------------------------------------------------------
+//! @{ \name Compress-store emulation on machines without AVX512
+// -----------------------------------------------------------------------
+
+#if defined(DRJIT_X86_SSE42) && !defined(DRJIT_X86_AVX512)
+/// Permutation tables that move the active 32-bit lanes to the front
+struct CompressTable {
+    /// Byte shuffles (for _mm_shuffle_epi8) indexed by a 4-bit lane mask
+    alignas(16) uint8_t lanes4[16][16];
+
+    /// Packed 4-bit lane indices (for _mm256_permutevar8x32) indexed by an 8-bit lane mask
+    uint32_t lanes8[256];
+
+    constexpr CompressTable() : lanes4(), lanes8() {
+        for (uint32_t m = 0; m < 16; ++m) {
+            uint32_t k = 0;
+            for (uint32_t i = 0; i < 4; ++i) {
+                if (m & (1u << i)) {
+                    for (uint32_t j = 0; j < 4; ++j)
+                        lanes4[m][k * 4 + j] = (uint8_t) (i * 4 + j);
+                    k++;
+                }
+            }
+            for (; k < 4; ++k) {
+                for (uint32_t j = 0; j < 4; ++j)
+                    lanes4[m][k * 4 + j] = 0x80;
+            }
+        }
+
+        for (uint32_t m = 0; m < 256; ++m) {
+            uint32_t k = 0;
+            for (uint32_t i = 0; i < 8; ++i) {
+                if (m & (1u << i))
+                    lanes8[m] |= i << (4 * k++);
+            }
+        }
+    }
+};
+
+inline constexpr CompressTable compress_table { };
+
+/// Convert a mask of 64-bit lanes into the equivalent mask of 32-bit lanes
+DRJIT_INLINE uint32_t compress_mask_64(uint32_t m) {
+    return ((m & 1) * 3) | ((m & 2) * 6) | ((m & 4) * 12) | ((m & 8) * 24);
+}
+
+/// Store the active 32-bit lanes of 'x' to 'ptr' (writes a full vector)
+DRJIT_INLINE void mm_compress_store_epi32(void *ptr, __m128i x, uint32_t m) {
+    __m128i shuf = _mm_load_si128((const __m128i *) compress_table.lanes4[m]);
+    _mm_storeu_si128((__m128i *) ptr, _mm_shuffle_epi8(x, shuf));
+}
+
+#if defined(DRJIT_X86_AVX2)
+/// Store the active 32-bit lanes of 'x' to 'ptr' (writes a full vector)
+DRJIT_INLINE void mm256_compress_store_epi32(void *ptr, __m256i x, uint32_t m) {
+    __m256i perm = _mm256_srlv_epi32(
+        _mm256_set1_epi32((int) compress_table.lanes8[m]),
+        _mm256_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28));
+    _mm256_storeu_si256((__m256i *) ptr, _mm256_permutevar8x32_epi32(x, perm));
+}
+#endif
+#endif
+
+//! @}
+// -----------------------------------------------------------------------
+
 // -----------------------------------------------------------------------
 //! @{ \name Mask conversion routines for various platforms
 // -----------------------------------------------------------------------
@@ -383,6 +449,13 @@ template <typename T> DRJIT_INLINE T tzcnt(T v) {
     DRJIT_INLINE StaticArrayImpl(                                              \
         const StaticArrayBase<Value2, Size, IsMask_, Derived2> &a)
 
+/// Variant of DRJIT_CONVERT() for half precision, which may be an incomplete type
+#define DRJIT_CONVERT_HALF                                                     \
+    template <typename Value2, typename Derived2,                              \
+              enable_if_t<std::is_same_v<Value2, half>> = 0>                   \
+    DRJIT_INLINE StaticArrayImpl(                                              \
+        const StaticArrayBase<Value2, Size, IsMask_, Derived2> &a)
+
 #define DRJIT_REINTERPRET(Value)                                               \
     template <typename Value2, typename Derived2, bool IsMask2,                \
               enable_if_t<detail::is_same_v<Value2, Value>> = 0>               \
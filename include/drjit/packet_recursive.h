@@ -247,6 +247,11 @@ struct StaticArrayImpl<Value_, Size_, IsMask_, Derived_,
             return maximum(max(a1), max(a2));
     }
 
+    DRJIT_INLINE Derived prefix_sum_(bool exclusive) const {
+        return Derived(prefix_sum(a1, exclusive),
+                       prefix_sum(a2, exclusive) + sum(a1));
+    }
+
     DRJIT_INLINE Value dot_(Ref a) const {
         if constexpr (Size1 == Size2) {
             if constexpr (std::is_floating_point_v<Value>)
@@ -286,6 +291,12 @@ struct StaticArrayImpl<Value_, Size_, IsMask_, Derived_,
         }
     }
 
+    template <typename Mask>
+    DRJIT_INLINE size_t compress_store_(void *ptr, const Mask &mask) const {
+        size_t count = compress_store(ptr, a1, low(mask));
+        return count + compress_store((Value *) ptr + count, a2, high(mask));
+    }
+
     //! @}
     // -----------------------------------------------------------------------
 
@@ -40,11 +40,11 @@ template <bool IsMask_, typename Derived_> struct alignas(16)
     //! @{ \name Type converting constructors
     // -----------------------------------------------------------------------
 
-// #if defined(DRJIT_X86_F16C)
-    // DRJIT_CONVERT(half) {
-    //     m = _mm_cvtph_ps(_mm_loadl_epi64((const __m128i *) a.derived().data()));
-    // }
-// #endif
+#if defined(DRJIT_X86_F16C)
+    DRJIT_CONVERT_HALF {
+        m = _mm_cvtph_ps(_mm_loadl_epi64((const __m128i *) a.derived().data()));
+    }
+#endif
 
     DRJIT_CONVERT(float) : m(a.derived().m) { }
     DRJIT_CONVERT(int32_t) : m(_mm_cvtepi32_ps(a.derived().m)) { }
@@ -371,6 +371,15 @@ template <bool IsMask_, typename Derived_> struct alignas(16)
         return _mm_cvtss_f32(_mm_dp_ps(m, a.m, 0b11110001));
     }
 
+    DRJIT_INLINE Derived prefix_sum_(bool exclusive) const {
+        __m128i x = _mm_castps_si128(m);
+        __m128 r = _mm_add_ps(m, _mm_castsi128_ps(_mm_slli_si128(x, 4)));
+        r = _mm_add_ps(r, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(r), 8)));
+        if (exclusive)
+            r = _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(r), 4));
+        return r;
+    }
+
     //! @}
     // -----------------------------------------------------------------------
 
@@ -386,6 +395,25 @@ template <bool IsMask_, typename Derived_> struct alignas(16)
         _mm_storeu_ps((Value *) ptr, m);
     }
 
+    template <typename Mask>
+    DRJIT_INLINE size_t compress_store_(void *ptr, const Mask &mask) const {
+        uint32_t bits = mask.bitmask_();
+#if defined(DRJIT_X86_AVX512)
+        _mm_mask_compressstoreu_ps(ptr, (__mmask8) bits, m);
+#else
+        detail::mm_compress_store_epi32(ptr, _mm_castps_si128(m), bits);
+#endif
+        return (size_t) _mm_popcnt_u32(bits);
+    }
+
+#if defined(DRJIT_X86_F16C)
+    /// Convert to half precision and store the result (used by Array<half, 4>)
+    DRJIT_INLINE void store_half_(void *ptr) const {
+        _mm_storel_epi64((__m128i *) ptr,
+                         _mm_cvtps_ph(m, _MM_FROUND_CUR_DIRECTION));
+    }
+#endif
+
     static DRJIT_INLINE Derived load_aligned_(const void *ptr, size_t) {
         return _mm_load_ps((const Value *) DRJIT_ASSUME_ALIGNED(ptr, 16));
     }
@@ -790,6 +818,14 @@ template <typename Value_, bool IsMask_, typename Derived_> struct alignas(16)
     #undef DRJIT_HORIZONTAL_OP
     #undef DRJIT_HORIZONTAL_OP_SIGNED
 
+    DRJIT_INLINE Derived prefix_sum_(bool exclusive) const {
+        __m128i r = _mm_add_epi32(m, _mm_slli_si128(m, 4));
+        r = _mm_add_epi32(r, _mm_slli_si128(r, 8));
+        if (exclusive)
+            r = _mm_slli_si128(r, 4);
+        return r;
+    }
+
     DRJIT_INLINE bool all_()  const { return _mm_movemask_ps(_mm_castsi128_ps(m)) == 0xF;}
     DRJIT_INLINE bool any_()  const { return _mm_movemask_ps(_mm_castsi128_ps(m)) != 0x0; }
 
@@ -811,6 +847,17 @@ template <typename Value_, bool IsMask_, typename Derived_> struct alignas(16)
         _mm_storeu_si128((__m128i *) ptr, m);
     }
 
+    template <typename Mask>
+    DRJIT_INLINE size_t compress_store_(void *ptr, const Mask &mask) const {
+        uint32_t bits = mask.bitmask_();
+#if defined(DRJIT_X86_AVX512)
+        _mm_mask_compressstoreu_epi32(ptr, (__mmask8) bits, m);
+#else
+        detail::mm_compress_store_epi32(ptr, m, bits);
+#endif
+        return (size_t) _mm_popcnt_u32(bits);
+    }
+
     static DRJIT_INLINE Derived load_aligned_(const void *ptr, size_t) {
         return _mm_load_si128((const __m128i *) DRJIT_ASSUME_ALIGNED(ptr, 16));
     }
@@ -1176,6 +1223,18 @@ template <bool IsMask_, typename Derived_> struct alignas(16)
         _mm_storeu_pd((Value *) ptr, m);
     }
 
+    template <typename Mask>
+    DRJIT_INLINE size_t compress_store_(void *ptr, const Mask &mask) const {
+        uint32_t bits = mask.bitmask_();
+#if defined(DRJIT_X86_AVX512)
+        _mm_mask_compressstoreu_pd(ptr, (__mmask8) bits, m);
+#else
+        detail::mm_compress_store_epi32(ptr, _mm_castpd_si128(m),
+                                        detail::compress_mask_64(bits));
+#endif
+        return (size_t) _mm_popcnt_u32(bits);
+    }
+
     static DRJIT_INLINE Derived load_aligned_(const void *ptr, size_t) {
         return _mm_load_pd((const Value *) DRJIT_ASSUME_ALIGNED(ptr, 16));
     }
@@ -1588,6 +1647,17 @@ template <typename Value_, bool IsMask_, typename Derived_> struct alignas(16)
         _mm_storeu_si128((__m128i *) ptr, m);
     }
 
+    template <typename Mask>
+    DRJIT_INLINE size_t compress_store_(void *ptr, const Mask &mask) const {
+        uint32_t bits = mask.bitmask_();
+#if defined(DRJIT_X86_AVX512)
+        _mm_mask_compressstoreu_epi64(ptr, (__mmask8) bits, m);
+#else
+        detail::mm_compress_store_epi32(ptr, m, detail::compress_mask_64(bits));
+#endif
+        return (size_t) _mm_popcnt_u32(bits);
+    }
+
     static DRJIT_INLINE Derived load_aligned_(const void *ptr, size_t) {
         return _mm_load_si128((const __m128i *) DRJIT_ASSUME_ALIGNED(ptr, 16));
     }
@@ -1636,16 +1706,16 @@ template <bool IsMask_, typename Derived_> struct alignas(16)
   : StaticArrayImpl<float, 4, IsMask_, Derived_> {
     DRJIT_PACKET_TYPE_3D(float)
 
-// #if defined(DRJIT_X86_F16C)
-    // template <typename Derived2>
-    // DRJIT_INLINE StaticArrayImpl(
-    //     const StaticArrayBase<half, 3, IsMask_, Derived2> &a) {
-    //     uint16_t temp[4];
-    //     memcpy(temp, a.derived().data(), sizeof(uint16_t) * 3);
-    //     temp[3] = 0;
-    //     m = _mm_cvtph_ps(_mm_loadl_epi64((const __m128i *) temp));
-    // }
-// #endif
+#if defined(DRJIT_X86_F16C)
+    template <typename Derived2>
+    DRJIT_INLINE StaticArrayImpl(
+        const StaticArrayBase<half, 3, IsMask_, Derived2> &a) {
+        uint16_t temp[4];
+        memcpy(temp, a.derived().data(), sizeof(uint16_t) * 3);
+        temp[3] = 0;
+        m = _mm_cvtph_ps(_mm_loadl_epi64((const __m128i *) temp));
+    }
+#endif
 
     template <int I0, int I1, int I2>
     DRJIT_INLINE Derived shuffle_() const {
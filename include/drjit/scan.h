@@ -0,0 +1,59 @@
+/*
+    drjit/scan.h -- Prefix sums of contiguous host buffers using packets
+
+    Dr.Jit is a C++ template library for efficient vectorization and
+    differentiation of numerical kernels on modern processor architectures.
+
+    Copyright (c) 2021 Wenzel Jakob <wenzel.jakob@epfl.ch>
+
+    All rights reserved. Use of this source code is governed by a BSD-style
+    license that can be found in the LICENSE file.
+*/
+
+#pragma once
+
+#include <drjit/packet.h>
+
+NAMESPACE_BEGIN(drjit)
+
+/**
+ * \brief Write an inclusive (default) or exclusive prefix sum of the \c size
+ * entries of \c in to \c out
+ *
+ * The buffer is processed one packet at a time using the in-register scan of
+ * \ref prefix_sum(), and the running total is carried into the next packet.
+ * The scan runs on the calling thread. \c in and \c out may refer to the same
+ * buffer.
+ */
+template <typename Value>
+void prefix_sum(const Value *in, Value *out, size_t size,
+                bool exclusive = false) {
+    static_assert(std::is_arithmetic_v<Value>,
+                  "prefix_sum(): expected an arithmetic type!");
+    using Block = Packet<Value>;
+    constexpr size_t BlockSize = Block::Size;
+
+    Value accum = Value(0);
+    size_t i = 0;
+    for (; i + BlockSize <= size; i += BlockSize) {
+        Block value = load<Block>(in + i),
+              scan  = prefix_sum(value, exclusive) + accum;
+        store(out + i, scan);
+        accum = scan.entry(BlockSize - 1);
+        if (exclusive)
+            accum += value.entry(BlockSize - 1);
+    }
+
+    for (; i < size; ++i) {
+        Value value = in[i];
+        if (exclusive) {
+            out[i] = accum;
+            accum += value;
+        } else {
+            accum += value;
+            out[i] = accum;
+        }
+    }
+}
+
+NAMESPACE_END(drjit)
@@ -36,6 +36,48 @@ enum class JitFlags : uint32_t;
 };
 
 NAMESPACE_BEGIN(drjit)
+
+NAMESPACE_BEGIN(detail)
+inline bool vcall_reorder_flag = false;
+inline bool vcall_merge_flag = false;
+NAMESPACE_END(detail)
+
+/**
+ * \brief Reorder the arguments of virtual function calls by instance?
+ *
+ * This only affects calls that aren't recorded (i.e., when
+ * JitFlag::VCallRecord is disabled). By default, every instance gathers its
+ * arguments from the (incoherent) lanes that reference it and scatters its
+ * results back. When reordering is enabled, all arguments are permuted by
+ * instance once, every instance processes a contiguous slice, and a single
+ * scatter restores the original order. This pays off for calls with many
+ * wide arguments.
+ */
+inline void set_vcall_reorder(bool value) { detail::vcall_reorder_flag = value; }
+
+/// Are the arguments of virtual function calls reordered? (see set_vcall_reorder())
+inline bool vcall_reorder() { return detail::vcall_reorder_flag; }
+
+/**
+ * \brief Merge the kernel launches of virtual function calls?
+ *
+ * This only affects calls that aren't recorded (i.e., when
+ * JitFlag::VCallRecord is disabled). By default, instances whose wavefronts
+ * have the same size are evaluated one after the other, which produces one
+ * kernel launch per instance. When merging is enabled, wavefronts are padded
+ * to the next power of two, and all instances that end up with the same size
+ * are fused into a single launch. The number of launches is then bounded by
+ * the logarithm of the call size rather than by the number of instances.
+ *
+ * The code of a merged kernel depends on which instances share a size class,
+ * hence this can cause additional compilation when the distribution of
+ * instances changes from one call to the next.
+ */
+inline void set_vcall_merge(bool value) { detail::vcall_merge_flag = value; }
+
+/// Are the kernel launches of virtual function calls merged? (see set_vcall_merge())
+inline bool vcall_merge() { return detail::vcall_merge_flag; }
+
 NAMESPACE_BEGIN(detail)
 
 template <typename T>
@@ -22,6 +22,29 @@ NAMESPACE_BEGIN(detail)
 
 using ConstStr = const char *;
 
+/// Are all JIT arrays within 'value' zero literals, e.g. gradients that were never set?
+template <typename T> bool is_zero_literal(const T &value) {
+    DRJIT_MARK_USED(value);
+    if constexpr (array_depth_v<T> > 1) {
+        for (size_t i = 0; i < value.derived().size(); ++i) {
+            if (!is_zero_literal(value.derived().entry(i)))
+                return false;
+        }
+        return true;
+    } else if constexpr (is_diff_v<T>) {
+        return is_zero_literal(value.detach_());
+    } else if constexpr (is_jit_v<T>) {
+        return !value.index() || (value.is_literal() && value.entry(0) == 0);
+    } else if constexpr (is_drjit_struct_v<T>) {
+        bool result = true;
+        struct_support_t<T>::apply_1(
+            value, [&](const auto &x) { result = result && is_zero_literal(x); });
+        return result;
+    } else {
+        return true;
+    }
+}
+
 template <typename DiffType, typename Self, typename Result, typename Func,
           typename... Args>
 struct DiffVCall : CustomOp<DiffType, Result, ConstStr, Self, Func, Args...> {
@@ -37,6 +60,8 @@ struct DiffVCall : CustomOp<DiffType, Result, ConstStr, Self, Func, Args...> {
         m_name_static = name;
         snprintf(m_name_long, sizeof(m_name_long), "VCall: %s::%s()",
                  Class::Domain, m_name_static);
+        snprintf(m_name_fwd, sizeof(m_name_fwd), "%s_ad_fwd", m_name_static);
+        snprintf(m_name_bwd, sizeof(m_name_bwd), "%s_ad_bwd", m_name_static);
 
         // Perform the function call
         size_t implicit_snapshot = ad_implicit<Type>();
@@ -59,6 +84,13 @@ struct DiffVCall : CustomOp<DiffType, Result, ConstStr, Self, Func, Args...> {
         const Self &self = Base::template value_in<1>();
         const Func &func = Base::template value_in<2>();
 
+        // Don't re-record all instances if there are no input tangents
+        bool zero = (is_zero_literal(Base::template grad_in<3 + Is>()) && ...);
+        for (size_t i = 0; zero && i < m_implicit_in.size(); ++i)
+            zero = is_zero_literal(ad_grad<Type>(m_implicit_in[i], false));
+        if (zero)
+            return;
+
         auto func_fwd = [func](auto *self2, auto... value_grad_pair) {
             ad_copy(value_grad_pair.first...);
             enable_grad(value_grad_pair.first...);
@@ -82,12 +114,8 @@ struct DiffVCall : CustomOp<DiffType, Result, ConstStr, Self, Func, Args...> {
             return grad<false>(result);
         };
 
-        size_t name_size = strlen(m_name_static) + 8;
-        dr_unique_ptr<char[]> name(new char[name_size]);
-        snprintf(name.get(), name_size, "%s_ad_fwd", m_name_static);
-
         Result grad_out = vcall_jit_record<Result>(
-            name.get(), func_fwd, self,
+            m_name_fwd, func_fwd, self,
             std::make_pair(Base::template value_in<3 + Is>(),
                            Base::template grad_in<3 + Is>())...);
 
@@ -100,6 +128,12 @@ struct DiffVCall : CustomOp<DiffType, Result, ConstStr, Self, Func, Args...> {
         const Func &func = Base::template value_in<2>();
         using Input = dr_tuple<Args...>;
 
+        // Don't re-record all instances if there is no output gradient
+        if constexpr (!std::is_same_v<Result, std::nullptr_t>) {
+            if (is_zero_literal(Base::grad_out()))
+                return;
+        }
+
         auto func_bwd = [func](auto *self2, auto &grad_out,
                                auto... args) -> Input {
             ad_copy(args...);
@@ -119,12 +153,8 @@ struct DiffVCall : CustomOp<DiffType, Result, ConstStr, Self, Func, Args...> {
             return Input(grad<false>(args)...);
         };
 
-        size_t name_size = strlen(m_name_static) + 8;
-        dr_unique_ptr<char[]> name(new char[name_size]);
-        snprintf(name.get(), name_size, "%s_ad_bwd", m_name_static);
-
         Input grad_in = vcall_jit_record<Input>(
-            name.get(), func_bwd, self, Base::grad_out(),
+            m_name_bwd, func_bwd, self, Base::grad_out(),
             Base::template value_in<3 + Is>()...);
 
         DRJIT_MARK_USED(grad_in);
@@ -140,6 +170,8 @@ struct DiffVCall : CustomOp<DiffType, Result, ConstStr, Self, Func, Args...> {
 private:
     const char *m_name_static = nullptr;
     char m_name_long[128];
+    char m_name_fwd[128];
+    char m_name_bwd[128];
 };
 
 inline std::pair<void *, uint32_t> vcall_registry_get(JitBackend Backend,
@@ -97,7 +97,6 @@ Result vcall_jit_record_impl(const char *name, uint32_t n_inst,
     (collect_indices(indices_in, args), ...);
 
     detail::JitState<Backend> jit_state;
-    snprintf(label, sizeof(label), "%s::%s", Base::Domain, name);
 
     if (!jit_state.begin_recording(name))
         return zeros<Result>();
@@ -106,9 +105,6 @@ Result vcall_jit_record_impl(const char *name, uint32_t n_inst,
 
     uint32_t n_inst_max = jit_registry_get_max(Backend, Base::Domain);
     for (uint32_t i = 1, j = 1; i <= n_inst_max; ++i) {
-        snprintf(label, sizeof(label), "VCall: %s::%s() [instance %u]",
-                 Base::Domain, name, j);
-
         Base *base = (Base *) jit_registry_get_ptr(Backend, Base::Domain, i);
         if (!base)
             continue;
@@ -116,6 +112,8 @@ Result vcall_jit_record_impl(const char *name, uint32_t n_inst,
         jit_set_scope(Backend, scope);
 
 #if defined(DRJIT_VCALL_DEBUG)
+        snprintf(label, sizeof(label), "VCall: %s::%s() [instance %u]",
+                 Base::Domain, name, j);
         jit_state.set_prefix(label);
 #endif
         jit_state.set_self(i);
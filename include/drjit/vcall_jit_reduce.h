@@ -33,6 +33,148 @@ DRJIT_INLINE decltype(auto) gather_helper(const T& value, const UInt32 &perm) {
     }
 }
 
+/**
+ * \brief Lanes processed by a single instance during a vcall in reduce mode
+ *
+ * When launches are merged (see set_vcall_merge()), the lane indices are
+ * padded to the next power of two by repeating the last lane, and the padded
+ * lanes are masked out.
+ */
+template <typename UInt32> struct VCallWavefront {
+    using Mask = mask_t<UInt32>;
+    static constexpr JitBackend Backend = detached_t<Mask>::Backend;
+
+    VCallWavefront(const UInt32 &index_, bool merge)
+        : index(index_), size(index_.size()) {
+        size_t padded = 1;
+        while (merge && padded < size)
+            padded <<= 1;
+
+        mask = Mask::steal(
+            jit_var_mask_default(Backend, (uint32_t) (merge ? padded : size)));
+
+        if (merge && padded != size) {
+            UInt32 lane = arange<UInt32>(padded);
+            index = gather<UInt32>(index, minimum(lane, (uint32_t) (size - 1)));
+            mask &= lane < (uint32_t) size;
+            size = padded;
+        }
+    }
+
+    UInt32 index;
+    Mask mask;
+    size_t size;
+};
+
+/**
+ * \brief Variant of vcall_jit_reduce_impl() that reorders the arguments by
+ * instance (see set_vcall_reorder())
+ *
+ * The buckets are concatenated into a single permutation that is applied to
+ * all arguments at once. Each instance then gathers a contiguous slice of
+ * the reordered arguments and scatters its results directly to their
+ * original lanes, like vcall_jit_reduce_impl().
+ */
+template <typename Result, typename Func, typename Self, size_t... Is,
+          typename... Args>
+Result vcall_jit_reduce_sorted(Func func, const Self &self,
+                               const VCallBucket *buckets, size_t n_inst,
+                               size_t self_size, std::index_sequence<Is...>,
+                               const Args &... args) {
+    using UInt32 = uint32_array_t<Self>;
+    using Class = scalar_t<Self>;
+    using Mask = mask_t<UInt32>;
+    static constexpr JitBackend Backend = detached_t<Mask>::Backend;
+    constexpr size_t N = sizeof...(Args);
+    DRJIT_MARK_USED(N);
+
+    struct SetSelfHelper {
+        void set(uint32_t value, uint32_t index) {
+            jit_vcall_set_self(Backend, value, index);
+        }
+
+        ~SetSelfHelper() {
+            jit_vcall_set_self(Backend, 0, 0);
+        }
+    };
+
+    bool merge = vcall_merge();
+
+    /* Concatenate the buckets into a single permutation. Merged launches pad
+       each slice to a power of two, which may extend past the last lane */
+    UInt32 perm = empty<UInt32>(self_size);
+    size_t offset = 0, padding = 0;
+    for (size_t i = 0; i < n_inst; ++i) {
+        UInt32 bucket = UInt32::borrow(buckets[i].index);
+        size_t size = bucket.size(), padded = 1;
+        while (merge && padded < size)
+            padded <<= 1;
+        if (offset + padded > self_size)
+            padding = std::max(padding, offset + padded - self_size);
+        scatter<true>(perm, bucket, arange<UInt32>(size) + (uint32_t) offset);
+        offset += size;
+    }
+
+    if (padding > 0)
+        perm = gather<UInt32>(
+            perm, minimum(arange<UInt32>(self_size + padding),
+                          (uint32_t) (self_size - 1)));
+
+    // Reorder all arguments once, and evaluate them so that slices are coherent
+    std::tuple sorted(gather_helper<Is, N>(args, perm)...);
+    UInt32 self_sorted = gather<UInt32>(self, perm);
+    eval(sorted, self_sorted);
+
+    Result result;
+    if constexpr (!std::is_same_v<Result, std::nullptr_t>)
+        result = empty<Result>(self_size);
+
+    SetSelfHelper self_helper;
+    size_t last_size = 0;
+    offset = 0;
+
+    for (size_t i = 0; i < n_inst; ++i) {
+        VCallWavefront<UInt32> wavefront(UInt32::borrow(buckets[i].index),
+                                         merge);
+        const UInt32 &target = wavefront.index;
+        size_t start = offset, size = wavefront.size;
+        UInt32 slice = arange<UInt32>(size) + (uint32_t) start;
+        offset += jit_var_size(buckets[i].index);
+
+        MaskScope<Mask> scope(wavefront.mask);
+
+        // Avoid merging multiple vcall launches if size repeats..
+        if (size != last_size || merge)
+            last_size = size;
+        else if constexpr (!std::is_same_v<Result, std::nullptr_t>)
+            eval(result);
+
+        if (buckets[i].ptr) {
+            UInt32 instance_id = gather<UInt32>(self_sorted, slice);
+            self_helper.set(buckets[i].id, instance_id.index());
+
+            if constexpr (!std::is_same_v<Result, std::nullptr_t>) {
+                using OrigResult = decltype(func((Class) nullptr, args...));
+                scatter<true>(
+                    result,
+                    ref_cast_t<OrigResult, Result>(func(
+                        (Class) buckets[i].ptr,
+                        gather_helper<Is, N>(std::get<Is>(sorted), slice)...)),
+                    target, wavefront.mask);
+            } else {
+                func((Class) buckets[i].ptr,
+                     gather_helper<Is, N>(std::get<Is>(sorted), slice)...);
+            }
+        } else {
+            if constexpr (!std::is_same_v<Result, std::nullptr_t>)
+                scatter<true>(result, zeros<Result>(), target, wavefront.mask);
+        }
+    }
+
+    schedule(result);
+    return result;
+}
+
 template <typename Result, typename Func, typename Self, size_t... Is,
           typename... Args>
 Result vcall_jit_reduce_impl(Func func, const Self &self_,
@@ -40,7 +182,6 @@ Result vcall_jit_reduce_impl(Func func, const Self &self_,
     using UInt32 = uint32_array_t<Self>;
     using Class = scalar_t<Self>;
     using Mask = mask_t<UInt32>;
-    static constexpr JitBackend Backend = detached_t<Mask>::Backend;
     constexpr size_t N = sizeof...(Args);
     DRJIT_MARK_USED(N);
 
@@ -76,24 +217,30 @@ Result vcall_jit_reduce_impl(Func func, const Self &self_,
     Self self = self_ & mask;
     auto [buckets, n_inst] = self.vcall_();
 
+    if (vcall_reorder() && n_inst > 1 && self_size > 0)
+        return vcall_jit_reduce_sorted<Result>(
+            func, self, buckets, n_inst, self_size,
+            std::index_sequence<Is...>(), args...);
+
     Result result;
     SetSelfHelper self_helper;
     if (n_inst > 0 && self_size > 0) {
         result = empty<Result>(self_size);
         size_t last_size = 0;
+        bool merge = vcall_merge();
 
         for (size_t i = 0; i < n_inst ; ++i) {
-            UInt32 perm = UInt32::borrow(buckets[i].index);
-            size_t wavefront_size = perm.size();
+            VCallWavefront<UInt32> wavefront(
+                UInt32::borrow(buckets[i].index), merge);
+            const UInt32 &perm = wavefront.index;
 
-            MaskScope<Mask> scope(Mask::steal(
-                jit_var_mask_default(Backend, (uint32_t) wavefront_size)));
+            MaskScope<Mask> scope(wavefront.mask);
 
             UInt32 instance_id = gather<UInt32>(self, perm);
 
             // Avoid merging multiple vcall launches if size repeats..
-            if (wavefront_size != last_size)
-                last_size = wavefront_size;
+            if (wavefront.size != last_size || merge)
+                last_size = wavefront.size;
             else
                 eval(result);
 
@@ -107,13 +254,14 @@ Result vcall_jit_reduce_impl(Func func, const Self &self_,
                         ref_cast_t<OrigResult, Result>(func(
                             (Class) buckets[i].ptr,
                             gather_helper<Is, N>(args, perm)...)),
-                        perm);
+                        perm, wavefront.mask);
                 } else {
                     func((Class) buckets[i].ptr, gather_helper<Is, N>(args, perm)...);
                 }
             } else {
                 if constexpr (!std::is_same_v<Result, std::nullptr_t>)
-                    scatter<true>(result, zeros<Result>(), perm);
+                    scatter<true>(result, zeros<Result>(), perm,
+                                  wavefront.mask);
             }
         }
         schedule(result);
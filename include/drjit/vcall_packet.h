@@ -28,13 +28,109 @@ DRJIT_INLINE Mask get_mask(const Arg &arg, const Args &... args) {
 }
 
 template <typename Arg, typename Mask>
-DRJIT_INLINE auto &replace_mask(Arg &arg, const Mask &mask) {
-    if constexpr (is_mask_v<Arg>)
-        return mask;
+DRJIT_INLINE decltype(auto) replace_mask(Arg &arg, const Mask &mask) {
+    if constexpr (is_mask_v<Arg> && !std::is_same_v<Arg, Mask>)
+        return Arg(mask); // e.g. mask of a float packet, 'mask' refers to pointers
+    else if constexpr (is_mask_v<Arg>)
+        return (const Mask &) mask;
+    else
+        return (Arg &) arg;
+}
+
+
+#if defined(DRJIT_X86_AVX512)
+/// Can vcall_leaders() process the given packet of instance pointers?
+template <typename Self> constexpr bool vcall_has_leaders() {
+    if constexpr (sizeof(scalar_t<Self>) != 8)
+        return false;
+    else if constexpr (is_packed_array_v<Self>)
+        return Self::Size == 8;
+    else if constexpr (is_recursive_array_v<Self>)
+        return Self::Size == 16 && is_packed_array_v<typename Self::Array1> &&
+               Self::Array1::Size == 8;
     else
-        return arg;
+        return false;
+}
+
+/// Bit mask of the 8 lanes that hold the first active occurrence of a pointer
+DRJIT_INLINE uint32_t vcall_leaders(__m512i self, __mmask8 mask) {
+    __mmask8 dup = _mm512_mask_test_epi64_mask(
+        mask, _mm512_conflict_epi64(self), _mm512_set1_epi64((long long) mask));
+    return (uint32_t) (__mmask8) (mask & ~dup);
 }
 
+#endif
+
+/**
+ * \brief Invoke <tt>body(instance, active)</tt> once for every distinct
+ * instance referenced by the active lanes of \c self
+ *
+ * The instances are found one at a time using extract(). With AVX512, only
+ * the first two are found that way, since most packets are coherent. Conflict
+ * detection then finds the remaining ones in one step, which avoids a
+ * compress per instance in divergent packets.
+ */
+template <typename Self, typename Mask, typename Body>
+DRJIT_INLINE void vcall_packet_dispatch(const Self &self, Mask mask, Body body) {
+    using Class = scalar_t<Self>;
+
+#if defined(DRJIT_X86_AVX512)
+    if constexpr (vcall_has_leaders<Self>()) {
+        for (int i = 0; i < 2; ++i) {
+            if (!any(mask))
+                return;
+            Class instance = extract(self, mask);
+            Mask active    = mask & eq(self, instance);
+            mask           = andnot(mask, active);
+            body(instance, active);
+        }
+
+        if (!any(mask))
+            return;
+
+        /* Copy the pointers and the mask into registers, the method calls
+           below would otherwise force them to be reloaded */
+        __m512i lo, hi = _mm512_setzero_si512();
+        __mmask8 klo, khi = 0;
+        if constexpr (Self::Size == 8) {
+            lo = self.m;
+            klo = mask.k;
+        } else {
+            lo = self.a1.m; hi = self.a2.m;
+            klo = mask.a1.k; khi = mask.a2.k;
+        }
+
+        uint32_t leaders = vcall_leaders(lo, klo);
+        if constexpr (Self::Size == 16)
+            leaders |= vcall_leaders(hi, khi) << 8;
+
+        while (leaders) {
+            Class instance = self.entry(tzcnt(leaders));
+            __m512i value = _mm512_set1_epi64((long long) instance);
+
+            Mask active;
+            if constexpr (Self::Size == 8) {
+                active.k = _mm512_mask_cmpeq_epi64_mask(klo, lo, value);
+                leaders &= ~(uint32_t) active.k;
+            } else {
+                active.a1.k = _mm512_mask_cmpeq_epi64_mask(klo, lo, value);
+                active.a2.k = _mm512_mask_cmpeq_epi64_mask(khi, hi, value);
+                leaders &= ~((uint32_t) active.a1.k |
+                             ((uint32_t) active.a2.k << 8));
+            }
+            body(instance, active);
+        }
+        return;
+    }
+#endif
+
+    while (any(mask)) {
+        Class instance = extract(self, mask);
+        Mask active    = mask & eq(self, instance);
+        mask           = andnot(mask, active);
+        body(instance, active);
+    }
+}
 
 template <typename Result, typename Func, typename Self, typename... Args>
 DRJIT_INLINE Result vcall_packet(Func func, const Self &self, const Args&... args) {
@@ -45,20 +141,15 @@ DRJIT_INLINE Result vcall_packet(Func func, const Self &self, const Args&... arg
 
     if constexpr (!std::is_void_v<Result>) {
         Result result = zeros<Result>(self.size());
-        while (any(mask)) {
-            Class instance         = extract(self, mask);
-            Mask active            = mask & eq(self, instance);
-            mask                   = andnot(mask, active);
-            masked(result, active) = func(instance, replace_mask(args, active)...);
-        }
+        vcall_packet_dispatch(self, mask, [&](Class instance, const Mask &active) DRJIT_INLINE_LAMBDA {
+            drjit::masked(result, mask_t<Result>(active)) =
+                func(instance, replace_mask(args, active)...);
+        });
         return result;
     } else {
-        while (any(mask)) {
-            Class instance    = extract(self, mask);
-            Mask active       = mask & eq(self, instance);
-            mask              = andnot(mask, active);
+        vcall_packet_dispatch(self, mask, [&](Class instance, const Mask &active) DRJIT_INLINE_LAMBDA {
             func(instance, replace_mask(args, active)...);
-        }
+        });
     }
 }
 
@@ -10,10 +10,12 @@
  *
  * Forward and reverse-mode traversal build on three main data structures:
  *
- * - 'state.variable': A hash table mapping from variable IDs (uint32_t) to
- *   'Variable' instances, which mainly stores the gradient associated with
- *   each variable, as well as links into the 'state.edges' list for
- *   connectivity.
+ * - 'state.variables': A slab of 'Variable' instances that is directly
+ *   addressed by the low bits of the variable IDs (uint32_t). Each variable
+ *   mainly stores the gradient associated with it, as well as links into the
+ *   'state.edges' list for connectivity. Unused slots are recycled in FIFO
+ *   order after a delay, and a per-slot generation counter (also part of the
+ *   ID) detects accesses to variables that were already freed.
  *
  * - 'state.edges': An interlinked array storing edges that provide
  *   connectivity between the variables. Each edge can be simple or special---a
@@ -26,6 +28,18 @@
  *   call to 'ad_traverse()'. This list is thread-local in contrast to the
  *   previous two data structures that are shared by all threads.
  *
+ * The first two data structures are part of a 'State' instance (a "shard" of
+ * the AD graph) that is protected by a mutex. By default, all threads share
+ * shard 0. Threads that call 'ad_set_thread_local(true)' instead claim a
+ * private shard so that graph construction and traversal on independent
+ * worker threads does not contend on a single lock. The shard owning a
+ * variable is encoded in the high bits of its index (see 'ad_shard()').
+ *
+ * Since variable slots are reused, variable IDs don't reflect the order in
+ * which variables were created. Each variable therefore also records a 64 bit
+ * creation counter that 'ad_traverse()' uses to visit edges in topological
+ * order.
+ *
  * To understand how everything fits together, start by looking at 'ad_new()'
  * and 'ad_traverse()': Arithmetic involving differentiable Dr.Jit arrays
  * triggers various calls to 'ad_new()', which creates the necessary variables
@@ -61,7 +75,12 @@
 #include <tsl/robin_set.h>
 #include <assert.h>
 #include <mutex>
+#include <atomic>
+#include <memory>
+#include <deque>
+#include <chrono>
 #include <xxh3.h>
+#include <nanothread/nanothread.h>
 
 NAMESPACE_BEGIN(drjit)
 NAMESPACE_BEGIN(detail)
@@ -85,6 +104,9 @@ NAMESPACE_BEGIN(detail)
 #define State                RENAME(State)
 #define ReleaseQueueHelper   RENAME(ReleaseQueueHelper)
 #define ReleaseOperandHelper RENAME(ReleaseOperandHelper)
+#define LocalState           RENAME(LocalState)
+#define StateGuard           RENAME(StateGuard)
+#define Tape                 RENAME(Tape)
 
 using Value = DRJIT_AUTODIFF_VALUE;
 using Mask = mask_t<Value>;
@@ -96,10 +118,27 @@ struct Variable;
 struct Special;
 
 static void ad_free(uint32_t index, Variable *v);
+static void ad_edge_unlink_fwd(Variable *source, uint32_t edge_id);
+template <typename T>
+static bool ad_grad_defer_sum(Variable *v, const T &value);
+static const char *ad_label_intern(const char *prefix, const char *label);
 template <typename Value, typename Mask, typename Index>
 uint32_t ad_new_gather_impl(const char *label, size_t size, uint32_t src_index,
                            const Index &offset, const Mask &mask, bool permute);
 
+/**
+ * \brief Return the ID of the graph shard that owns the variable 'index'
+ *
+ * Indices of the shared graph (shard 0) have their high bit cleared.
+ * Thread-local shards set the high bit and store their ID in bits 26..30,
+ * which leaves 26 bits to address the variables of each such shard. The
+ * remaining bits are split into a slot and a generation counter (see
+ * \ref State::index()).
+ */
+static uint32_t ad_shard(uint32_t index) {
+    return (index & 0x80000000u) ? ((index >> 26) & 0x1fu) : 0u;
+}
+
 template <typename T> bool is_valid(const T &value) {
     if constexpr (is_jit_v<T>)
         return value.valid();
@@ -122,9 +161,11 @@ template <typename T> bool is_valid(const T &value) {
  *
  * Instead of storing an explicit adjacency list of the AD graph structure, the
  * adjacency information is directly encoded in the edges. In particular, the
- * 'next_fwd' and 'next_bwd' indices each implement a singly linked list that
- * can be used to iterate through the forward edges (of the 'source' variable)
- * and backward edges (of the 'target' variable).
+ * 'next_fwd' and 'next_bwd' indices each implement a linked list that can be
+ * used to iterate through the forward edges (of the 'source' variable) and
+ * backward edges (of the 'target' variable). The lists are doubly linked via
+ * 'prev_fwd' and 'prev_bwd' so that edges can be removed in constant time
+ * even when a variable has a very large number of edges.
  */
 struct Edge {
     /// Variable index of source operand
@@ -142,16 +183,25 @@ struct Edge {
     /// Visited bit
     uint32_t visited : 1;
 
+    /// Links to the previous forward edge
+    uint32_t prev_fwd;
+
+    /// Links to the previous backward edge
+    uint32_t prev_bwd : 31;
+
+    /// Does this edge have unit weight? (in which case 'weight' is empty)
+    uint32_t identity : 1;
+
     /// Pointer to a handler for "special" edges
     Special *special;
 
-    /// Weight value (zero/empty for "special" edges)
+    /// Weight value (zero/empty for "special" and identity edges)
     Value weight{};
 
     DRJIT_ARRAY_DEFAULTS(Edge);
 
     Edge() {
-        memset(this, 0, sizeof(uint32_t) * 4 + sizeof(Special *));
+        memset(this, 0, sizeof(uint32_t) * 6 + sizeof(Special *));
     }
 
     /// Reset the contents of this edge to the default values
@@ -191,16 +241,22 @@ struct Variable {
     /// Descriptive label or nullptr
     char *label;
 
-    /// High bits of variable index (unused atm.)
-    uint32_t index_hi : 16;
+    /// Generation of the slot storing this variable (see \ref State::index())
+    uint32_t generation : 15;
+
+    /// Is this slot currently occupied by a variable?
+    uint32_t used : 1;
 
     /// Gradient reference count for custom operations
-    uint32_t ref_count_grad : 13;
+    uint32_t ref_count_grad : 12;
+
+    /// Are there deferred gradient contributions? (see \ref PendingGrad)
+    uint32_t pending_grad : 1;
 
     /// Was the label manually overwritten via set_label()?
     uint32_t custom_label : 1;
 
-    /// Should the label be freed when the variable is deallocated?
+    /// Should the label be freed when the variable is deallocated? (custom labels only)
     uint32_t free_label : 1;
 
     /// Was this graph node created while recording computation?
@@ -209,6 +265,9 @@ struct Variable {
     /// This field may or may not hold a valid gradient value
     Value grad{};
 
+    /// Creation counter, establishes a topological order of all variables
+    uint64_t counter = 0;
+
     Variable() {
         memset(this, 0, sizeof(char *) + 5 * sizeof(uint32_t));
     }
@@ -223,13 +282,8 @@ struct Variable {
         size = (uint32_t) size_;
 
         const char *prefix = ad_prefix();
-        if (prefix) {
-            size_t size_2 = strlen(prefix) + strlen(label) + 2;
-            char *out = (char *) malloc(size_2);
-            snprintf(out, size_2, "%s/%s", prefix, label);
-            label = out;
-            free_label = 1;
-        }
+        if (prefix)
+            label = (char *) ad_label_intern(prefix, label);
 
         placeholder = (uint32_t) placeholder_;
     }
@@ -259,6 +313,8 @@ struct Variable {
                     v2 = v * scalar_t<Value>(src_size);
                 } else {
                     assert(v.size() == src_size);
+                    if (ad_grad_defer_sum(this, v))
+                        return;
                     v2 = sum(v);
                 }
 
@@ -326,6 +382,8 @@ struct Variable {
                     v3 *= scalar_t<Value>(src_size);
                 } else {
                     assert(v3.size() == src_size);
+                    if (ad_grad_defer_sum(this, v3))
+                        return;
                     v3 = sum(v3);
                 }
 
@@ -349,17 +407,113 @@ struct Variable {
     DRJIT_ARRAY_DEFAULTS(Variable);
 };
 
+/**
+ * \brief Deferred gradient contributions of a variable
+ *
+ * The backward pass of a gather scatter-adds into a gradient buffer that
+ * matches the size of the source variable. When only a small part of a large
+ * array (e.g., an embedding table or texture atlas) was accessed, this mostly
+ * moves zeros. GatherEdge::backward() therefore records the offsets and
+ * values here, and they are only added to the dense gradient once an
+ * operation requires it (see ad_grad_flush()). ad_grad_sparse() and
+ * ad_accum_grad_into() access them without densifying.
+ *
+ * With ADFlag::CombineGathers, the backward pass of all other gathers is
+ * deferred as well. Gathers that use the same offsets and mask (e.g., several
+ * uses of one gathered value) share an entry whose values are summed, which
+ * replaces several atomic scatters into the same locations by one.
+ *
+ * Similarly, wide gradients flowing into a size-1 variable (e.g., a parameter
+ * broadcast to many consumers) are not reduced one by one. Variable::accum()
+ * and Variable::mul_accum() instead add them element-wise to the 'sums'
+ * entry of matching width, which is reduced once by ad_grad_flush().
+ */
+struct PendingGrad {
+    std::vector<Index> offsets;
+    std::vector<Value> values;
+    std::vector<Mask> masks;
+
+    /// Maps the JIT variable indices of offset and mask to an entry
+    tsl::robin_map<uint64_t, size_t> entries;
+
+    template <typename I = Index, typename M = Mask, typename T = Value>
+    void put(const I &offset, const M &mask, const T &value) {
+        if constexpr (is_jit_v<T>) {
+            uint64_t key = ((uint64_t) offset.index() << 32) | mask.index();
+            auto [it, inserted] = entries.try_emplace(key, offsets.size());
+            if (!inserted) {
+                values[it->second] += value;
+                return;
+            }
+        }
+
+        offsets.push_back(offset);
+        values.push_back(value);
+        masks.push_back(mask);
+    }
+
+    /// Wide contributions to a size-1 variable, one per distinct width
+    std::vector<Value> sums;
+
+    template <typename T = Value> void put_sum(const T &value) {
+        for (T &s : sums) {
+            if (s.size() == value.size()) {
+                s += value;
+                return;
+            }
+        }
+        sums.push_back(value);
+    }
+
+    /// Reduce the wide contributions and add them to 'grad'
+    template <typename T = Value> void reduce_sums(T &grad) {
+        if constexpr (is_jit_v<T>) {
+            for (const T &s : sums) {
+                T value = sum(s);
+                if (is_valid(grad))
+                    grad += value;
+                else
+                    grad = std::move(value);
+            }
+        }
+        sums.clear();
+    }
+};
+
 /// Records the (global) state of the AD graph
 struct State {
-    using VariableMap = tsl::robin_map<uint32_t, Variable, UInt32Hasher,
-                                       std::equal_to<uint32_t>>;
-    using EdgeVector  = std::vector<Edge>;
+    /// Variables are allocated in blocks of 2^BlockShift to keep pointers stable
+    static constexpr uint32_t BlockShift = 12;
+    static constexpr uint32_t BlockSize = 1u << BlockShift;
+
+    using VariableBlock = std::unique_ptr<Variable[]>;
+    using EdgeVector    = std::vector<Edge>;
 
     /// std::mutex protecting the state data structure
     std::mutex mutex;
 
-    /// Hash table mapping variable IDs to variable instances
-    VariableMap variables;
+    /// Slab of variable slots, indexed by the low bits of the variable ID
+    std::vector<VariableBlock> variables;
+
+    /**
+     * \brief Queue of currently unused variable slots
+     *
+     * Slots are reused in FIFO order once more than \ref ReuseDelay of them
+     * are queued, so that a stale ID only aliases a new variable after its
+     * slot was reused <tt>2^generation_bits</tt> times (i.e., after at least
+     * 32 * 1024 variables were freed, or 16 * 1024 in thread-local shards).
+     * Wrap-around of the generation counter remains possible beyond that.
+     */
+    std::deque<uint32_t> unused_variables;
+
+    /// Minimum number of freed slots that are queued before reusing one
+    static constexpr size_t ReuseDelay = 1024;
+
+    /// Number of variable slots handed out so far (slot 0 is never used)
+    uint32_t variable_slots = 1;
+
+    /// Number of variables that are currently in use
+    size_t variable_count = 0;
 
     /// List of all edges (used and unused ones)
     EdgeVector edges;
@@ -367,20 +521,38 @@ struct State {
     /// List of currently unused edges
     std::vector<uint32_t> unused_edges;
 
-    /// Counter for variable indices
-    uint32_t variable_index = 1;
+    /// Interned literal edge weights, indexed by their bit pattern (JIT only)
+    tsl::robin_map<uint64_t, Value> weights;
+
+    /// Counters reported by ad_stats() (the '*_live' fields are unused here)
+    ADStats stats;
+
+    /// Deferred gradient contributions of variables with 'pending_grad' set
+    tsl::robin_map<const Variable *, PendingGrad> pending_grads;
+
+    /// High bits identifying variables of this shard (see \ref ad_shard())
+    uint32_t index_base = 0;
+
+    /// Number of low index bits that address a variable slot
+    uint32_t slot_bits = 26;
+
+    /// Number of index bits storing the slot generation (above 'slot_bits')
+    uint32_t generation_bits = 5;
 
     State() : edges(1) { }
 
     ~State() {
-        if (!variables.empty()) {
+        if (variable_count) {
             ad_log(Warn,
                    "drjit-autodiff: variable leak detected (%zu variables "
-                   "remain in use)!", variables.size());
+                   "remain in use)!", variable_count);
             uint32_t counter = 0;
-            for (auto kv : variables) {
-                ad_log(Warn, " - variable a%u (%u references)", kv.first,
-                       kv.second.ref_count);
+            for (uint32_t i = 1; i < variable_slots; ++i) {
+                const Variable *v = slot(i);
+                if (!v->used)
+                    continue;
+                ad_log(Warn, " - variable a%u (%u references)", index(i, v),
+                       v->ref_count);
                 if (++counter == 10) {
                     ad_log(Warn, " - (skipping the rest)");
                     break;
@@ -395,11 +567,33 @@ struct State {
                    "remain in use)!", edges_used);
     }
 
+    /// Return the variable stored in slot 'i' (which may be unused)
+    Variable *slot(uint32_t i) {
+        return &variables[i >> BlockShift][i & (BlockSize - 1)];
+    }
+
+    /// Compute the variable ID of slot 'i' holding the variable 'v'
+    uint32_t index(uint32_t i, const Variable *v) const {
+        uint32_t generation = v->generation & ((1u << generation_bits) - 1);
+        return index_base | (generation << slot_bits) | i;
+    }
+
+    /// Look up a variable, returns \c nullptr if it does not exist (anymore)
+    Variable *find(uint32_t index) {
+        uint32_t i = index & ((1u << slot_bits) - 1);
+        if (unlikely(i == 0 || i >= variable_slots))
+            return nullptr;
+        Variable *v = slot(i);
+        if (unlikely(!v->used || this->index(i, v) != index))
+            return nullptr;
+        return v;
+    }
+
     Variable *operator[](uint32_t index) {
-        auto it = variables.find(index);
-        if (unlikely(index == 0 || it == variables.end()))
+        Variable *v = find(index);
+        if (unlikely(!v))
             ad_fail("referenced an unknown variable a%u!", index);
-        return &it.value();
+        return v;
     }
 };
 
@@ -408,9 +602,12 @@ struct EdgeRef {
     uint32_t source;
     uint32_t target;
 
-    EdgeRef() : id(0), source(0), target(0) { }
+    /// Sort key, set by ad_traverse() based on the variable creation counter
+    uint64_t key;
+
+    EdgeRef() : id(0), source(0), target(0), key(0) { }
     EdgeRef(uint32_t id, uint32_t source, uint32_t target)
-    : id(id), source(source), target(target) { }
+    : id(id), source(source), target(target), key(0) { }
 };
 
 /**
@@ -437,14 +634,18 @@ struct Scope {
      */
     bool isolate = false;
 
-    // Current variable index when entering this scope
-    uint32_t variable_index = 0;
+    // Variable creation counter when entering this scope
+    uint64_t counter = 0;
 
     /**
      * \brief Depending on the value of 'complement', this set specifies
      * variables for which AD is enabled or disabled.
+     *
+     * Nested scopes and custom operations share the set of the scope they
+     * were created from and only copy it once they modify it. A null pointer
+     * denotes the empty set.
      */
-    IndexSet indices;
+    std::shared_ptr<IndexSet> indices;
 
     /// List of AD postponed edges that will be traversed when leaving the scope
     std::vector<EdgeRef> postponed;
@@ -455,9 +656,37 @@ struct Scope {
     Scope& operator=(Scope&&) = default;
     Scope& operator=(const Scope&) = default;
 
+    /// Copy this scope (except for the postponed edges) in constant time
+    Scope fork() const {
+        Scope result;
+        result.type = type;
+        result.complement = complement;
+        result.isolate = isolate;
+        result.counter = counter;
+        result.indices = indices;
+        return result;
+    }
+
+    /// Is the 'indices' set empty?
+    bool indices_empty() const { return !indices || indices->empty(); }
+
+    /// Does the 'indices' set contain 'index'?
+    bool contains(uint32_t index) const {
+        return indices && indices->find(index) != indices->end();
+    }
+
+    /// Return the 'indices' set for modification, copying it if it is shared
+    IndexSet &indices_mut() {
+        if (!indices)
+            indices = std::make_shared<IndexSet>();
+        else if (indices.use_count() > 1)
+            indices = std::make_shared<IndexSet>(*indices);
+        return *indices;
+    }
+
     /// Check if a variable has gradients enabled
     bool enabled(uint32_t index) const {
-        return (indices.find(index) != indices.end()) != complement;
+        return contains(index) != complement;
     }
 
     /// Potentially zero out 'index' if the variable has gradients disabled
@@ -469,24 +698,24 @@ struct Scope {
 
     /// Track gradients for the given variable
     void enable(uint32_t index) {
-        if (!index)
+        if (!index || contains(index) != complement)
             return;
 
         if (complement)
-            indices.erase(index);
+            indices_mut().erase(index);
         else
-            indices.insert(index);
+            indices_mut().insert(index);
     }
 
     /// Disable gradients for the given variable
     void disable(uint32_t index) {
-        if (!index)
+        if (!index || contains(index) == complement)
             return;
 
         if (complement)
-            indices.insert(index);
+            indices_mut().insert(index);
         else
-            indices.erase(index);
+            indices_mut().erase(index);
     }
 };
 
@@ -506,11 +735,63 @@ struct Special {
     virtual ~Special() = default;
 };
 
+/// Traversal schedule captured by an AD tape (see ad_tape_begin())
+struct Tape {
+    /**
+     * \brief Edge of the captured schedule
+     *
+     * Edges and variables created while the tape was active are referenced
+     * by their creation rank (bits 0, 1, and 2 of 'ranked' for 'id',
+     * 'source', and 'target'), which remains valid when an identical graph
+     * is created again. Other references use plain indices.
+     */
+    struct Ref {
+        uint32_t id;
+        uint32_t source;
+        uint32_t target;
+        uint32_t ranked;
+    };
+
+    /// AD variables created since ad_tape_begin(), in creation order
+    std::vector<uint32_t> variables;
+
+    /// Edges created since ad_tape_begin(), in creation order
+    std::vector<uint32_t> edges;
+
+    /// The captured schedule, i.e., the sorted output of ad_enqueue()
+    std::vector<Ref> schedule;
+
+    /// Traversal direction of the captured schedule
+    ADMode mode = ADMode::Backward;
+
+    /// Has a schedule been captured?
+    bool recorded = false;
+};
+
 // Stores per-thread state
+/// A "prefix/label" string created by ad_label_intern()
+struct InternedLabel {
+    const char *value;
+    size_t prefix_size;
+};
+
+using LabelKey = std::pair<const char *, const char *>;
+
+struct LabelKeyHasher {
+    size_t operator()(const LabelKey &key) const {
+        return std::hash<const void *>()(key.first) * 31 +
+               std::hash<const void *>()(key.second);
+    }
+};
+
 struct LocalState {
     /// Thread-local edge list used by ad_enqueue_*() and ad_traverse()
     std::vector<EdgeRef> todo;
 
+    /// Scratch space used by ad_sort_edges()
+    std::vector<EdgeRef> sort_tmp;
+    std::vector<uint32_t> sort_offsets;
+
     /// Keeps track of implicit input dependencies of recorded computation
     std::vector<EdgeRef> implicit;
 
@@ -520,36 +801,261 @@ struct LocalState {
     /// List of special edges that should be cleaned up
     std::vector<Special *> cleanup;
 
-    ~LocalState() {
-        for (Special *s : cleanup)
-            delete s;
+    /// Tape tracking graph construction by this thread (see ad_tape_begin())
+    Tape *tape = nullptr;
 
-        if (!scopes.empty())
-            ad_log(Warn,
-                   "drjit-autodiff: scope leak detected (%zu scopes "
-                   "remain in use)!", scopes.size());
-    }
+    /// Number of active traversals (callbacks of special edges may nest them)
+    uint32_t traverse_depth = 0;
+
+    /// Number of tangents propagated by ad_forward_batch() (0 if inactive)
+    size_t batch_size = 0;
+
+    /// Tangents of the variables reached by ad_forward_batch(), by index
+    tsl::robin_map<uint32_t, std::vector<Value>, UInt32Hasher> batch;
+
+    /// Graph shard claimed by this thread (0 if none)
+    uint32_t shard = 0;
+
+    /// Did this thread already try to claim a graph shard?
+    bool shard_claimed = false;
+
+    /// Labels interned by this thread, avoids locking 'label_table'
+    tsl::robin_map<LabelKey, InternedLabel, LabelKeyHasher> labels;
+
+    ~LocalState();
 };
 
 constexpr bool IsDouble = std::is_same_v<Value, double>;
-static_assert(sizeof(Edge) == 8 * sizeof(uint32_t),
+static_assert(sizeof(Edge) == 10 * sizeof(uint32_t),
               "Edge data structure has incorrect size. Padding problem?");
 
-static_assert(sizeof(Variable) == ((IsDouble ? 2 : 0) + 8) * sizeof(uint32_t),
+static_assert(sizeof(Variable) == ((IsDouble ? 2 : 0) + 10) * sizeof(uint32_t),
               "Variable data structure has incorrect size. Padding problem?");
 
 // ==========================================================================
 // Global state variables, thread local storage
 // ==========================================================================
 
-/// Global state, protected by a mutex
-static State state;
+/// Maximum number of graph shards (shard 0 is shared by all threads)
+constexpr uint32_t ShardCount = 32;
+
+/// Graph shards, each protected by its own mutex
+static State shards[ShardCount];
+
+/// Protects the 'shard_owned' table
+static std::mutex shard_mutex;
+
+/// Which of the thread-local graph shards are currently claimed by a thread?
+static bool shard_owned[ShardCount];
+
+/// Creation counter of the most recently created variable (see \ref Variable)
+static std::atomic<uint64_t> variable_counter { 0 };
+
+/// Shard that was most recently locked by the current thread (see StateGuard)
+static thread_local State *state_active = nullptr;
 
 /// Thread-local state
 static thread_local LocalState local_state;
 
+/// Interned labels of all threads, entries are never released
+static std::mutex label_mutex;
+static tsl::robin_map<LabelKey, InternedLabel, LabelKeyHasher> label_table;
+
+/**
+ * \brief Return the label 'prefix/label'
+ *
+ * Prefixes are interned by ad_prefix_push(), and labels are typically string
+ * literals. The combination is therefore looked up by address and only
+ * formatted once, so that creating a variable doesn't allocate memory. The
+ * label is compared in case its address was reused for a different string.
+ */
+static const char *ad_label_intern(const char *prefix, const char *label) {
+    LabelKey key(prefix, label);
+    auto matches = [label](const InternedLabel &l) {
+        return strcmp(l.value + l.prefix_size + 1, label) == 0;
+    };
+
+    auto it = local_state.labels.find(key);
+    if (likely(it != local_state.labels.end() && matches(it->second)))
+        return it->second.value;
+
+    InternedLabel result;
+    /* critical section */ {
+        std::lock_guard<std::mutex> guard(label_mutex);
+        auto it2 = label_table.find(key);
+        if (it2 != label_table.end() && matches(it2->second)) {
+            result = it2->second;
+        } else {
+            size_t prefix_size = strlen(prefix),
+                   size = prefix_size + strlen(label) + 2;
+            char *value = (char *) malloc_check(size);
+            snprintf(value, size, "%s/%s", prefix, label);
+            result = InternedLabel{ value, prefix_size };
+            label_table[key] = result;
+        }
+    }
+
+    local_state.labels[key] = result;
+    return result.value;
+}
+
+/// Return the number of seconds that have elapsed since 'before'
+static double ad_seconds_since(std::chrono::steady_clock::time_point before) {
+    return std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - before).count();
+}
+
+/// RAII helper to lock a graph shard and make it the active one on this thread
+struct StateGuard {
+    StateGuard(State &state) : prev(state_active) {
+        if (unlikely(!state.mutex.try_lock())) {
+            // Only time the lock when another thread holds it
+            auto before = std::chrono::steady_clock::now();
+            void *token = ad_wait_begin ? ad_wait_begin() : nullptr;
+            state.mutex.lock();
+            if (ad_wait_end)
+                ad_wait_end(token);
+            state.stats.lock_contentions++;
+            state.stats.lock_wait_time += ad_seconds_since(before);
+        }
+        state_active = &state;
+    }
+
+    ~StateGuard() {
+        state_active->mutex.unlock();
+        state_active = prev;
+    }
+
+    StateGuard(const StateGuard &) = delete;
+    StateGuard &operator=(const StateGuard &) = delete;
+
+    State *prev;
+};
+
+/// Add the deferred gradient contributions of 'v' to its dense gradient
+template <typename T = Value> static void ad_grad_flush(Variable *v) {
+    State &state = *state_active;
+    auto it = state.pending_grads.find(v);
+    v->pending_grad = 0;
+    if (it == state.pending_grads.end())
+        return;
+
+    if constexpr (is_jit_v<T>) {
+        PendingGrad &sg = it->second;
+        T &grad = v->grad;
+        sg.reduce_sums(grad);
+        if (sg.offsets.empty()) {
+            state.pending_grads.erase(it);
+            return;
+        }
+
+        if (!grad.valid())
+            grad = zeros<T>(v->size);
+        else if ((uint32_t) grad.size() != v->size)
+            grad.resize(v->size);
+
+        for (size_t i = 0; i < sg.offsets.size(); ++i)
+            scatter_reduce(ReduceOp::Add, grad, sg.values[i], sg.offsets[i],
+                           sg.masks[i]);
+    }
+
+    state.pending_grads.erase(it);
+}
+
+/// Release the gradient of 'v' along with any deferred contributions
+static void ad_grad_clear(Variable *v) {
+    v->grad = Value();
+    if (unlikely(v->pending_grad)) {
+        state_active->pending_grads.erase(v);
+        v->pending_grad = 0;
+    }
+}
+
+/**
+ * \brief Defer the reduction of the wide gradient contribution 'value' to the
+ * size-1 variable 'v' (see \ref PendingGrad)
+ *
+ * Returns \c false when the contribution must be reduced immediately.
+ */
+template <typename T>
+static bool ad_grad_defer_sum(Variable *v, const T &value) {
+    if constexpr (is_jit_v<T>) {
+        if (v->placeholder || local_state.batch_size ||
+            !jit_flag(JitFlag::ADOptimize) || jit_flag(JitFlag::Recording))
+            return false;
+
+        state_active->pending_grads[v].put_sum(value);
+        v->pending_grad = 1;
+        return true;
+    } else {
+        DRJIT_MARK_USED(v);
+        DRJIT_MARK_USED(value);
+        return false;
+    }
+}
+
+/// Return the graph shard that owns the variable 'index'
+static State &ad_state(uint32_t index) {
+    return shards[ad_shard(index)];
+}
+
+/// Return the graph shard that receives new variables of the current thread
+static State &ad_state_local() {
+    if (likely(!ad_thread_local()))
+        return shards[0];
+
+    LocalState &ls = local_state;
+    if (unlikely(!ls.shard_claimed)) {
+        ls.shard_claimed = true;
+
+        std::lock_guard<std::mutex> guard(shard_mutex);
+        for (uint32_t i = 1; i < ShardCount; ++i) {
+            if (shard_owned[i])
+                continue;
+            shard_owned[i] = true;
+            ls.shard = i;
+
+            State &state = shards[i];
+            std::lock_guard<std::mutex> guard_2(state.mutex);
+            if (state.index_base == 0) {
+                state.index_base = 0x80000000u | (i << 26);
+                state.slot_bits = 22;
+                state.generation_bits = 4;
+            }
+            break;
+        }
+
+        if (!ls.shard)
+            ad_log(Warn, "drjit-autodiff: all %u thread-local graph shards are "
+                   "in use, falling back to the shared AD graph.",
+                   ShardCount - 1);
+    }
+
+    return shards[ls.shard];
+}
+
+LocalState::~LocalState() {
+    /* Special edge callbacks temporarily release the mutex of the active
+       shard, which must therefore be held while deleting them */ {
+        StateGuard guard(shards[0]);
+        for (Special *s : cleanup)
+            delete s;
+    }
+
+    if (!scopes.empty())
+        ad_log(Warn,
+               "drjit-autodiff: scope leak detected (%zu scopes "
+               "remain in use)!", scopes.size());
+
+    // Hand the graph shard over to other threads (its variables remain valid)
+    if (shard) {
+        std::lock_guard<std::mutex> guard(shard_mutex);
+        shard_owned[shard] = false;
+    }
+}
+
 void Edge::reset() {
-    memset(this, 0, sizeof(uint32_t) * 4 + sizeof(Special *));
+    memset(this, 0, sizeof(uint32_t) * 6 + sizeof(Special *));
     weight = Value();
 }
 
@@ -582,7 +1088,8 @@ static bool ad_dec_ref(uint32_t index, Variable *v) noexcept (true) {
 template <typename T> void ad_inc_ref_impl(uint32_t index) noexcept(true) {
     if (likely(index == 0))
         return;
-    std::lock_guard<std::mutex> guard(state.mutex);
+    State &state = ad_state(index);
+    StateGuard guard(state);
     ad_inc_ref(index, state[index]);
 }
 
@@ -597,7 +1104,8 @@ template <typename T> uint32_t ad_inc_ref_cond_impl(uint32_t index) noexcept(tru
             return 0;
     }
 
-    std::lock_guard<std::mutex> guard(state.mutex);
+    State &state = ad_state(index);
+    StateGuard guard(state);
     ad_inc_ref(index, state[index]);
     return index;
 }
@@ -605,7 +1113,8 @@ template <typename T> uint32_t ad_inc_ref_cond_impl(uint32_t index) noexcept(tru
 template <typename T> void ad_dec_ref_impl(uint32_t index) noexcept(true) {
     if (index == 0)
         return;
-    std::lock_guard<std::mutex> guard(state.mutex);
+    State &state = ad_state(index);
+    StateGuard guard(state);
 
     if (unlikely(ad_dec_ref(index, state[index]))) {
         /* Extra-careful here: deallocate cleanup queue of
@@ -624,6 +1133,7 @@ template <typename T> void ad_dec_ref_impl(uint32_t index) noexcept(true) {
 }
 
 static void ad_free(uint32_t index, Variable *v) {
+    State &state = *state_active;
     ad_trace("ad_free(a%u)", index);
 
     if (v->free_label) {
@@ -644,46 +1154,42 @@ static void ad_free(uint32_t index, Variable *v) {
             ad_fail("ad_free(): invalid edge connectivity!");
 
         uint32_t source = edge.source,
-                 next_bwd = edge.next_bwd,
-                 next_fwd = edge.next_fwd;
+                 next_bwd = edge.next_bwd;
 
         assert(edge.target == index);
 
+        Variable *v2 = state[source];
+        ad_edge_unlink_fwd(v2, edge_id);
+
         // Postpone deallocation of the edge callback, if there is one
         if (unlikely(edge.special))
             local_state.cleanup.push_back(edge.special);
         edge.reset();
 
-        Variable *v2 = state[source];
-
         if (unlikely(v2->ref_count == 0))
             ad_fail("drjit-autodiff: fatal error: reference count of variable "
                     "a%u became negative!", source);
 
-        if (!ad_dec_ref(source, v2)) {
-            uint32_t fwd = v2->next_fwd;
-            if (fwd == edge_id) {
-                v2->next_fwd = next_fwd;
-            } else {
-                while (true) {
-                    Edge &edge2 = state.edges[fwd];
-                    assert(edge2.source == source);
-                    if (edge2.next_fwd != edge_id) {
-                        fwd = edge2.next_fwd;
-                    } else {
-                        edge2.next_fwd = next_fwd;
-                        break;
-                    }
-                }
-            }
-        }
+        ad_dec_ref(source, v2);
 
         state.unused_edges.push_back(edge_id);
 
         edge_id = next_bwd;
     }
 
-    state.variables.erase(index);
+    if (unlikely(v->pending_grad))
+        state.pending_grads.erase(v);
+
+    // Release the slot, invalidating any remaining references to 'index'
+    uint32_t generation = v->generation + 1;
+    *v = Variable();
+    v->generation = generation;
+    state.unused_variables.push_back(index & ((1u << state.slot_bits) - 1));
+    state.variable_count--;
+
+    // Release interned edge weights once the graph is empty
+    if (state.variable_count == 0 && !state.weights.empty())
+        state.weights.clear();
 }
 
 // ==========================================================================
@@ -693,26 +1199,50 @@ static void ad_free(uint32_t index, Variable *v) {
 /// Allocate a new variable
 static std::pair<uint32_t, Variable *> ad_var_new(const char *label,
                                                   size_t size) {
-    while (true) {
-        uint32_t index = state.variable_index++;
+    State &state = *state_active;
+    uint32_t slot = state.variable_slots;
+    size_t unused = state.unused_variables.size();
+
+    // Only reuse slots once enough are queued, or when the slab is full
+    if (likely(unused > State::ReuseDelay ||
+               (unused > 0 && (slot >> state.slot_bits)))) {
+        slot = state.unused_variables.front();
+        state.unused_variables.pop_front();
+    } else {
+        if (unlikely(slot >> state.slot_bits))
+            ad_raise("ad_var_new(): the AD graph exceeded the maximum number "
+                     "of variables (%u)!", (1u << state.slot_bits) - 1);
+        if ((slot >> State::BlockShift) == state.variables.size())
+            state.variables.emplace_back(new Variable[State::BlockSize]);
+        state.variable_slots++;
+    }
 
-        if (unlikely(index == 0)) { // overflow
-            state.variable_index = 1;
-            index = state.variable_index++;
-        }
+    bool rec = false;
+    if (is_jit_v<Value>)
+        rec = jit_flag(JitFlag::Recording);
 
-        bool rec = false;
-        if (is_jit_v<Value>)
-            rec = jit_flag(JitFlag::Recording);
+    Variable *v = state.slot(slot);
+    uint32_t generation = v->generation;
+    *v = Variable(label, size, rec);
+    v->generation = generation;
+    v->used = 1;
+    v->counter = ++variable_counter;
+    state.variable_count++;
+    state.stats.variables_created++;
 
-        auto result = state.variables.try_emplace(index, label, size, rec);
-        if (likely(result.second))
-            return { index, &result.first.value() };
-    }
+    uint32_t index = state.index(slot, v);
+
+    // Temporary graphs created by nested traversals are not part of the tape
+    Tape *tape = local_state.tape;
+    if (unlikely(tape) && !local_state.traverse_depth)
+        tape->variables.push_back(index);
+
+    return { index, v };
 }
 
 /// Allocate a new edge from the pool
 static uint32_t ad_edge_new() {
+    State &state = *state_active;
     uint32_t index;
     if (likely(!state.unused_edges.empty())) {
         index = state.unused_edges.back();
@@ -721,12 +1251,121 @@ static uint32_t ad_edge_new() {
         index = (uint32_t) state.edges.size();
         state.edges.emplace_back();
     }
+
+    ADStats &stats = state.stats;
+    stats.edges_created++;
+    uint64_t edges_live = state.edges.size() - state.unused_edges.size() - 1;
+    if (edges_live > stats.edges_peak)
+        stats.edges_peak = edges_live;
+
+    // Temporary graphs created by nested traversals are not part of the tape
+    Tape *tape = local_state.tape;
+    if (unlikely(tape) && !local_state.traverse_depth)
+        tape->edges.push_back(index);
+
     return index;
 }
 
+/// Maximum number of distinct literal edge weights interned per graph shard
+constexpr size_t WeightPoolSize = 64;
+
+/**
+ * \brief Store the weight of a new edge
+ *
+ * Unit weights only set the 'identity' bit, which lets traversal skip the
+ * multiplication. Other literal weights of JIT variants are interned so that
+ * all edges with the same constant weight share a single JIT variable.
+ */
+template <typename T>
+static void ad_edge_set_weight(Edge &edge, T &&weight) {
+    using Type = std::decay_t<T>;
+    if constexpr (is_jit_v<Type>) {
+        if (weight.is_literal() && weight.size() == 1 &&
+            jit_flag(JitFlag::ADOptimize)) {
+            scalar_t<Type> value = weight[0];
+            if (value == 1) {
+                edge.identity = 1;
+                return;
+            }
+
+            uint64_t key = 0;
+            memcpy(&key, &value, sizeof(value));
+
+            State &state = *state_active;
+            auto it = state.weights.find(key);
+            if (it != state.weights.end()) {
+                edge.weight = it->second;
+                return;
+            } else if (state.weights.size() < WeightPoolSize) {
+                state.weights.emplace(key, weight);
+            }
+        }
+    } else {
+        if (weight == 1) {
+            edge.identity = 1;
+            return;
+        }
+    }
+
+    edge.weight = std::move(weight);
+}
+
+/// Insert the edge 'edge_id' at the front of the forward edge list of 'source'
+static void ad_edge_link_fwd(Variable *source, uint32_t edge_id) {
+    State &state = *state_active;
+    Edge &edge = state.edges[edge_id];
+    edge.prev_fwd = 0;
+    edge.next_fwd = source->next_fwd;
+    if (edge.next_fwd)
+        state.edges[edge.next_fwd].prev_fwd = edge_id;
+    source->next_fwd = edge_id;
+}
+
+/// Insert the edge 'edge_id' at the front of the backward edge list of 'target'
+static void ad_edge_link_bwd(Variable *target, uint32_t edge_id) {
+    State &state = *state_active;
+    Edge &edge = state.edges[edge_id];
+    edge.prev_bwd = 0;
+    edge.next_bwd = target->next_bwd;
+    if (edge.next_bwd)
+        state.edges[edge.next_bwd].prev_bwd = edge_id;
+    target->next_bwd = edge_id;
+}
+
+/// Remove the edge 'edge_id' from the forward edge list of 'source'
+static void ad_edge_unlink_fwd(Variable *source, uint32_t edge_id) {
+    State &state = *state_active;
+    Edge &edge = state.edges[edge_id];
+    if (edge.prev_fwd)
+        state.edges[edge.prev_fwd].next_fwd = edge.next_fwd;
+    else if (likely(source->next_fwd == edge_id))
+        source->next_fwd = edge.next_fwd;
+    else
+        ad_fail("ad_edge_unlink_fwd(): invalid forward edge connectivity!");
+    if (edge.next_fwd)
+        state.edges[edge.next_fwd].prev_fwd = edge.prev_fwd;
+    edge.prev_fwd = edge.next_fwd = 0;
+}
+
+/// Remove the edge 'edge_id' from the backward edge list of 'target'
+static void ad_edge_unlink_bwd(Variable *target, uint32_t edge_id) {
+    State &state = *state_active;
+    Edge &edge = state.edges[edge_id];
+    if (edge.prev_bwd)
+        state.edges[edge.prev_bwd].next_bwd = edge.next_bwd;
+    else if (likely(target->next_bwd == edge_id))
+        target->next_bwd = edge.next_bwd;
+    else
+        ad_fail("ad_edge_unlink_bwd(): invalid backward edge connectivity!");
+    if (edge.next_bwd)
+        state.edges[edge.next_bwd].prev_bwd = edge.prev_bwd;
+    edge.prev_bwd = edge.next_bwd = 0;
+}
+
 
 /// Ensure consistent size of placeholder variables to avoid horiz. reductions
 static void ad_propagate_placeholder_size(Variable *v) {
+    State &state = *state_active;
     uint32_t edge = v->next_bwd;
     while (edge) {
         Edge &e = state.edges[edge];
@@ -739,6 +1378,29 @@ static void ad_propagate_placeholder_size(Variable *v) {
     }
 }
 
+/**
+ * \brief Return the graph shard that should store a new variable depending on
+ * the operands 'op'. Variables without operands are created in the shard of
+ * the calling thread. Mixing variables from different shards is not allowed.
+ */
+static State &ad_state_select(const char *name, const uint32_t *op,
+                              uint32_t op_count) {
+    State *result = nullptr;
+    for (uint32_t i = 0; i < op_count; ++i) {
+        if (op[i] == 0)
+            continue;
+        State *s = &ad_state(op[i]);
+        if (!result)
+            result = s;
+        else if (unlikely(result != s))
+            ad_raise("%s(): operands a%u and a%u belong to the AD graphs of "
+                     "different threads! Thread-local AD graphs (see "
+                     "ad_set_thread_local()) cannot be combined.",
+                     name, op[0], op[i]);
+    }
+    return result ? *result : ad_state_local();
+}
+
 /// RAII helper class to clean up reference counts of a limited # of operands
 struct ReleaseOperandHelper {
     uint32_t pos = 0;
@@ -753,7 +1415,7 @@ struct ReleaseOperandHelper {
     ~ReleaseOperandHelper() {
         for (uint32_t i = 0; i < pos; ++i) {
             uint32_t index = values[i];
-            ad_dec_ref(index, state[index]);
+            ad_dec_ref(index, (*state_active)[index]);
         }
     }
 };
@@ -764,9 +1426,8 @@ void ad_scope_enter(ADScope type, size_t size, const uint32_t *indices) {
     Scope scope;
 
     if (!scopes.empty())
-        scope = scopes.back();
+        scope = scopes.back().fork();
 
-    scope.postponed.clear();
     scope.type = type;
 
     switch (type) {
@@ -778,7 +1439,7 @@ void ad_scope_enter(ADScope type, size_t size, const uint32_t *indices) {
                     scope.disable(indices[i]);
             } else {
                 scope.complement = false;
-                scope.indices.clear();
+                scope.indices.reset();
             }
             break;
 
@@ -788,11 +1449,11 @@ void ad_scope_enter(ADScope type, size_t size, const uint32_t *indices) {
             if (size) {
                 for (size_t i = 0; i < size; ++i)
                     scope.enable(indices[i]);
-                if (!scope.complement && scope.indices.empty())
-                    scope.indices.insert(0);
+                if (!scope.complement && scope.indices_empty())
+                    scope.indices_mut().insert(0);
             } else {
                 scope.complement = true;
-                scope.indices.clear();
+                scope.indices.reset();
             }
             break;
 
@@ -802,11 +1463,9 @@ void ad_scope_enter(ADScope type, size_t size, const uint32_t *indices) {
                         "specified for this scope type!");
 
             scope.isolate = true;
-            /* access state data structure */ {
-                std::lock_guard<std::mutex> guard(state.mutex);
-                scope.variable_index = state.variable_index;
-            }
-            ad_log(Debug, "ad_scope_enter(isolate, a%u...)", scope.variable_index);
+            scope.counter = variable_counter + 1;
+            ad_log(Debug, "ad_scope_enter(isolate, counter=%llu)",
+                   (unsigned long long) scope.counter);
             break;
 
         default:
@@ -879,19 +1538,30 @@ template <typename T> bool ad_enabled() noexcept(true) {
         const Scope &scope = scopes.back();
 
         // Check if AD is disabled on the current thread
-        if (!scope.complement && scope.indices.empty())
+        if (!scope.complement && scope.indices_empty())
             return false;
     }
 
-    std::lock_guard<std::mutex> guard(state.mutex);
-    return !state.variables.empty();
+    /* access state data structure */ {
+        StateGuard guard(shards[0]);
+        if (shards[0].variable_count)
+            return true;
+    }
+
+    if (!ad_thread_local())
+        return false;
+
+    State &state = ad_state_local();
+    if (&state == &shards[0])
+        return false;
+
+    StateGuard guard(state);
+    return state.variable_count != 0;
 }
 
 template <typename T>
 uint32_t ad_new(const char *label, size_t size, uint32_t op_count,
                 uint32_t *op, T *weights) {
-    std::lock_guard<std::mutex> guard(state.mutex);
-
     /* Potentially turn off derivative tracking for some of the operands if
        we're within a scope that enables/disables gradient propagation
        (globally, or only for specific variables) */
@@ -903,7 +1573,7 @@ uint32_t ad_new(const char *label, size_t size, uint32_t op_count,
         if (op_count == 0) {
             // If AD is completely disabled (i.e. this is an dr.suspend_grad()
             // region), don't allow creating new AD variables
-            active = scope.complement || !scope.indices.empty();
+            active = scope.complement || !scope.indices_empty();
         } else {
             for (uint32_t i = 0; i < op_count; ++i)
                 active |= scope.maybe_disable(op[i]);
@@ -913,6 +1583,9 @@ uint32_t ad_new(const char *label, size_t size, uint32_t op_count,
             return 0;
     }
 
+    State &state = ad_state_select("ad_new", op, op_count);
+    StateGuard guard(state);
+
     bool rec = false;
     if constexpr (is_jit_v<Value>)
         rec = jit_flag(JitFlag::Recording);
@@ -994,13 +1667,12 @@ uint32_t ad_new(const char *label, size_t size, uint32_t op_count,
         Edge &edge = state.edges[edge_index_new];
         edge.source = index2;
         edge.target = index;
-        edge.weight = std::move(weights[i]);
-        edge.next_fwd = var2->next_fwd;
-        edge.next_bwd = edge_index;
+        ad_edge_set_weight(edge, std::move(weights[i]));
+        ad_edge_link_fwd(var2, edge_index_new);
+        ad_edge_link_bwd(var, edge_index_new);
         edge_index = edge_index_new;
 
         ad_inc_ref(index2, var2);
-        var2->next_fwd = edge_index_new;
     }
 
     if (op_count > 0 && edge_index == 0) {
@@ -1011,7 +1683,6 @@ uint32_t ad_new(const char *label, size_t size, uint32_t op_count,
         return 0;
     }
 
-    var->next_bwd = edge_index;
     var->ref_count = 1;
 
     if (var->placeholder)
@@ -1072,13 +1743,11 @@ template <typename Value> struct SpecialCallback : Special {
 
             if (!scopes.empty()) {
                 bool isolate = scopes.back().isolate;
-                scopes.push_back(scope);
+                scopes.push_back(scope.fork());
                 scopes.back().isolate = isolate;
             } else {
-                scopes.push_back(scope);
+                scopes.push_back(scope.fork());
             }
-
-            scopes.back().postponed.clear();
         }
 
         ~PushScope() {
@@ -1104,7 +1773,7 @@ template <typename Value> struct SpecialCallback : Special {
 
     virtual ~SpecialCallback() {
         /* outside of critical section */ {
-            unlock_guard<std::mutex> guard(state.mutex);
+            unlock_guard<std::mutex> guard(state_active->mutex);
             callback.reset();
         }
     }
@@ -1114,6 +1783,7 @@ template <typename Value> struct SpecialCallback : Special {
 
     void backward(Variable *, const Variable *target, uint32_t flags) const override {
         ad_trace("ad_traverse(): invoking user callback ..");
+        State &state = *state_active;
         uint32_t edge = target->next_fwd;
 
         /* leave critical section */ {
@@ -1129,7 +1799,7 @@ template <typename Value> struct SpecialCallback : Special {
                 if (v->ref_count_grad > 0 && --v->ref_count_grad == 0) {
                     if (((flags & (uint32_t) ADFlag::ClearInterior) && v->next_fwd != 0) ||
                         ((flags & (uint32_t) ADFlag::ClearInput) && v->next_fwd == 0))
-                        v->grad = Value();
+                        ad_grad_clear(v);
                 }
                 edge = e.next_fwd;
             } while (edge);
@@ -1138,6 +1808,7 @@ template <typename Value> struct SpecialCallback : Special {
 
     void forward(const Variable *source, Variable *, uint32_t flags) const override {
         ad_trace("ad_traverse(): invoking user callback ..");
+        State &state = *state_active;
         uint32_t edge = source->next_bwd;
         /* leave critical section */ {
             unlock_guard<std::mutex> guard(state.mutex);
@@ -1154,8 +1825,8 @@ template <typename Value> struct SpecialCallback : Special {
                     if (((flags & (uint32_t) ADFlag::ClearInterior) && v->next_bwd != 0) ||
                         ((flags & (uint32_t) ADFlag::ClearInput) && v->next_bwd == 0)) {
 
-                        if (!(scope.isolate && e.source < scope.variable_index))
-                            v->grad = Value();
+                        if (!(scope.isolate && v->counter < scope.counter))
+                            ad_grad_clear(v);
                     }
                 }
 
@@ -1168,7 +1839,10 @@ template <typename Value> struct SpecialCallback : Special {
 template <typename Value, typename Mask>
 uint32_t ad_new_select(const char *label, size_t size, const Mask &mask,
                        uint32_t t_index, uint32_t f_index) {
-    std::lock_guard<std::mutex> guard(state.mutex);
+    uint32_t op[2] = { t_index, f_index };
+    State &state = ad_state_select("ad_new_select", op, 2);
+    StateGuard guard(state);
+
     if constexpr (is_jit_v<Mask>) {
         if (jit_flag(JitFlag::ADOptimize) && mask.is_literal()) {
             uint32_t result = mask[0] ? t_index : f_index;
@@ -1204,7 +1878,6 @@ uint32_t ad_new_select(const char *label, size_t size, const Mask &mask,
     if constexpr (is_jit_v<Value>)
         rec = jit_flag(JitFlag::Recording);
 
-    uint32_t op[2] = { t_index, f_index };
     ReleaseOperandHelper helper;
 
     if (rec) {
@@ -1233,7 +1906,6 @@ uint32_t ad_new_select(const char *label, size_t size, const Mask &mask,
                 index = ad_new_gather_impl<Value>("gather", size, op[i], Index(0),
                                                   Mask(true), false);
 
-                var = state[index];
                 op[i] = index;
                 helper.put(index);
             }
@@ -1243,7 +1915,6 @@ uint32_t ad_new_select(const char *label, size_t size, const Mask &mask,
     auto [index, var] = ad_var_new(label, size);
 
     ad_log(Debug, "ad_new_select(a%u <- a%u, a%u)", index, t_index, f_index);
-    uint32_t edge_index = 0;
     for (uint32_t i = 0; i < 2; ++i) {
         if (op[i] == 0)
             continue;
@@ -1256,16 +1927,13 @@ uint32_t ad_new_select(const char *label, size_t size, const Mask &mask,
         edge.source = index2;
         edge.target = index;
         edge.special = new MaskEdge<Value>(mask, i != 0);
-        edge.next_fwd = var2->next_fwd;
-        edge.next_bwd = edge_index;
-        edge_index = edge_index_new;
+        state.stats.mask_edges++;
+        ad_edge_link_fwd(var2, edge_index_new);
+        ad_edge_link_bwd(var, edge_index_new);
 
         ad_inc_ref(index2, var2);
-
-        var2->next_fwd = edge_index_new;
     }
 
-    var->next_bwd = edge_index;
     var->ref_count = 1;
 
     if (var->placeholder)
@@ -1295,6 +1963,12 @@ template <typename Mask> struct MaskGuard {
 };
 
 
+/// Gathers from variables with at least this many entries..
+constexpr uint32_t SparseGradMinSize = 1u << 16;
+
+/// .. that access at most 1/SparseGradRatio of them produce sparse gradients
+constexpr uint32_t SparseGradRatio = 16;
+
 template <typename Value> struct GatherEdge : Special {
     GatherEdge(const Index &offset, const Mask &mask, bool permute)
         : offset(offset), mask(mask), permute(permute) {
@@ -1306,7 +1980,7 @@ template <typename Value> struct GatherEdge : Special {
         }
     }
 
-    void backward(Variable *source, const Variable *target, uint32_t) const override {
+    void backward(Variable *source, const Variable *target, uint32_t flags) const override {
         Value &source_grad = (Value &) source->grad;
         uint32_t size = source->size;
 
@@ -1316,6 +1990,20 @@ template <typename Value> struct GatherEdge : Special {
             return;
         }
 
+        bool sparse = size >= SparseGradMinSize &&
+                      (uint64_t) width(offset) * SparseGradRatio <= size,
+             combine = (flags & (uint32_t) ADFlag::CombineGathers) != 0;
+
+        if (!permute && (sparse || combine) && !source->placeholder &&
+            !target->placeholder && jit_flag(JitFlag::ADOptimize) &&
+            !jit_flag(JitFlag::Recording)) {
+            // Defer the scatter, see \ref PendingGrad
+            state_active->pending_grads[source].put(offset, mask & mask_stack,
+                                                   target->grad);
+            source->pending_grad = 1;
+            return;
+        }
+
         if (!source_grad.valid())
             source_grad = zeros<Value>(size);
         else if ((uint32_t) source_grad.size() != size)
@@ -1363,6 +2051,7 @@ uint32_t ad_new_gather_impl(const char *label, size_t size, uint32_t src_index,
                 return 0;
         }
 
+        State &state = *state_active;
         auto [index, var] = ad_var_new(label, size);
 
         ad_log(Debug, "ad_new_gather(a%u <- a%u, size=%zu, permute=%i)", index,
@@ -1375,11 +2064,10 @@ uint32_t ad_new_gather_impl(const char *label, size_t size, uint32_t src_index,
         edge.source = src_index;
         edge.target = index;
         edge.special = new GatherEdge<Value>(offset, mask, permute);
-        edge.next_fwd = var2->next_fwd;
-        edge.next_bwd = 0;
+        state.stats.gather_edges++;
+        ad_edge_link_fwd(var2, edge_index_new);
+        ad_edge_link_bwd(var, edge_index_new);
         ad_inc_ref(src_index, var2);
-        var2->next_fwd = edge_index_new;
-        var->next_bwd = edge_index_new;
         var->ref_count = 1;
 
         /* Encountered a dependency between recorded/non-recorded computation
@@ -1407,7 +2095,7 @@ uint32_t ad_new_gather_impl(const char *label, size_t size, uint32_t src_index,
 template <typename Value, typename Mask, typename Index>
 uint32_t ad_new_gather(const char *label, size_t size, uint32_t src_index,
                       const Index &offset, const Mask &mask, bool permute) {
-    std::lock_guard<std::mutex> guard(state.mutex);
+    StateGuard guard(ad_state_select("ad_new_gather", &src_index, 1));
     return ad_new_gather_impl<Value>(label, size, src_index, offset, mask, permute);
 }
 
@@ -1461,7 +2149,9 @@ uint32_t ad_new_scatter(const char *label, size_t size, ReduceOp op,
     DRJIT_MARK_USED(mask);
 
     if constexpr (is_array_v<Value>) {
-        std::lock_guard<std::mutex> guard(state.mutex);
+        uint32_t op_idx[2] = { src_index, dst_index };
+        State &state = ad_state_select("ad_new_scatter", op_idx, 2);
+        StateGuard guard(state);
 
         if (is_jit_v<Value>) {
             // Apply the mask stack (needed for wavefront-mode dr::Loop)
@@ -1500,10 +2190,10 @@ uint32_t ad_new_scatter(const char *label, size_t size, ReduceOp op,
             edge.source = src_index;
             edge.target = index;
             edge.special = new ScatterEdge<Value>(offset, mask, op);
-            edge.next_fwd = var2->next_fwd;
-            edge.next_bwd = var->next_bwd;
+            state.stats.scatter_edges++;
+            ad_edge_link_fwd(var2, edge_index_new);
+            ad_edge_link_bwd(var, edge_index_new);
             ad_inc_ref(src_index, var2);
-            var2->next_fwd = edge_index_new;
             edge_index = edge_index_new;
         }
 
@@ -1514,24 +2204,24 @@ uint32_t ad_new_scatter(const char *label, size_t size, ReduceOp op,
             Edge &edge2 = state.edges[edge_index_new];
             edge2.source = dst_index;
             edge2.target = index;
-            edge2.next_fwd = var2->next_fwd;
-            edge2.next_bwd = edge_index;
             if (op != ReduceOp::None || permute) {
-                edge2.weight = 1;
+                edge2.identity = 1;
             } else {
                 Mask edge_mask = full<Mask>(false, size);
                 scatter(edge_mask, Mask(true), offset, mask);
-                edge2.special = new MaskEdge<Value>(edge_mask, true);
+                state.edges[edge_index_new].special =
+                    new MaskEdge<Value>(edge_mask, true);
+                state.stats.mask_edges++;
             }
+            ad_edge_link_fwd(var2, edge_index_new);
+            ad_edge_link_bwd(var, edge_index_new);
             ad_inc_ref(dst_index, var2);
-            var2->next_fwd = edge_index_new;
             edge_index = edge_index_new;
         }
 
         if (edge_index == 0)
             ad_raise("ad_new_scatter(): all inputs were non-differentiable!");
 
-        var->next_bwd = edge_index;
         ad_inc_ref(index, var);
 
         /* If we're selectively tracking gradients and this operation generates a
@@ -1559,22 +2249,25 @@ template <typename T> T ad_grad(uint32_t index, bool fail_if_missing) {
     if (unlikely(index == 0))
         return T(0);
 
-    std::lock_guard<std::mutex> guard(state.mutex);
-    auto it = state.variables.find(index);
-    if (it == state.variables.end()) {
+    State &state = ad_state(index);
+    StateGuard guard(state);
+    Variable *v = state.find(index);
+    if (!v) {
         if (fail_if_missing)
             ad_raise("ad_grad(): referenced an unknown variable a%u!", index);
         return T(0);
     }
 
-    const Variable &v = it->second;
-    T result = v.grad;
+    if (unlikely(v->pending_grad))
+        ad_grad_flush(v);
+
+    T result = v->grad;
 
     if constexpr (is_jit_v<T>) {
         if (!is_valid(result))
-            result = zeros<T>(v.size);
-        else if (result.size() != v.size)
-            result.resize(v.size);
+            result = zeros<T>(v->size);
+        else if (result.size() != v->size)
+            result.resize(v->size);
     }
 
     return result;
@@ -1588,27 +2281,30 @@ void ad_set_grad(uint32_t index, const T &value, bool fail_if_missing) {
     if (unlikely(index == 0))
         return;
 
-    std::lock_guard<std::mutex> guard(state.mutex);
-    auto it = state.variables.find(index);
-    if (it == state.variables.end()) {
+    State &state = ad_state(index);
+    StateGuard guard(state);
+    Variable *v = state.find(index);
+    if (!v) {
         if (fail_if_missing)
             ad_raise("ad_set_grad(): referenced an unknown variable a%u!", index);
         return;
     }
 
     size_t size_in = width(value);
-    Variable &v = it.value();
 
-    if (v.size != size_in && size_in != 1 && v.size != 1)
+    if (v->size != size_in && size_in != 1 && v->size != 1)
         ad_raise("ad_set_grad(): attempted to assign a gradient of size "
                  "%zu to AD variable a%u, which has size %u!",
-                 size_in, index, v.size);
+                 size_in, index, v->size);
 
     ad_trace("ad_set_grad(a%u)", index);
-    if (v.size != 1 || size_in == 1)
-        v.grad = value;
+    if (unlikely(v->pending_grad))
+        ad_grad_clear(v);
+
+    if (v->size != 1 || size_in == 1)
+        v->grad = value;
     else
-        v.grad = sum(value);
+        v->grad = sum(value);
 }
 
 template <typename T>
@@ -1619,35 +2315,140 @@ void ad_accum_grad(uint32_t index, const T &value, bool fail_if_missing) {
     if (unlikely(index == 0))
         return;
 
-    std::lock_guard<std::mutex> guard(state.mutex);
-    auto it = state.variables.find(index);
-    if (it == state.variables.end()) {
+    State &state = ad_state(index);
+    StateGuard guard(state);
+    Variable *v = state.find(index);
+    if (!v) {
         if (fail_if_missing)
             ad_raise("ad_accum_grad(): referenced an unknown variable a%u!", index);
         return;
     }
 
     size_t size_in = width(value);
-    Variable &v = it.value();
 
-    if (v.size != size_in && size_in != 1 && v.size != 1)
+    if (v->size != size_in && size_in != 1 && v->size != 1)
         ad_raise("ad_accum_grad(): attempted to accumulate a gradient of size "
                  "%zu into AD variable a%u, which has size %u!",
-                 size_in, index, v.size);
+                 size_in, index, v->size);
 
     ad_trace("ad_accum_grad(a%u)", index);
-    v.accum(value, (uint32_t) size_in);
+    v->accum(value, (uint32_t) size_in);
+}
+
+template <typename T, typename I>
+void ad_grad_sparse(uint32_t index, I &offsets, T &values) {
+    offsets = I();
+    values = T();
+    if (unlikely(index == 0))
+        return;
+
+    State &state = ad_state(index);
+    StateGuard guard(state);
+    Variable *v = state.find(index);
+    if (!v)
+        ad_raise("ad_grad_sparse(): referenced an unknown variable a%u!", index);
+
+    if constexpr (is_jit_v<T>) {
+        std::vector<I> offsets_in;
+        std::vector<T> values_in;
+
+        auto it = state.pending_grads.find(v);
+        if (it != state.pending_grads.end())
+            it.value().reduce_sums(v->grad);
+
+        if (is_valid(v->grad)) {
+            offsets_in.push_back(arange<I>(v->size));
+            values_in.push_back(v->grad);
+        }
+
+        if (it != state.pending_grads.end()) {
+            const PendingGrad &sg = it->second;
+            for (size_t i = 0; i < sg.offsets.size(); ++i) {
+                // Disabled entries may hold arbitrary offsets
+                offsets_in.push_back(select(sg.masks[i], sg.offsets[i], 0u));
+                values_in.push_back(select(sg.masks[i], sg.values[i], 0.f));
+            }
+        }
+
+        if (offsets_in.size() == 1 && width(values_in[0]) == width(offsets_in[0])) {
+            offsets = std::move(offsets_in[0]);
+            values = std::move(values_in[0]);
+            return;
+        }
+
+        // Concatenate the contributions
+        size_t size = 0;
+        for (const I &o : offsets_in)
+            size += width(o);
+
+        offsets = zeros<I>(size);
+        values = zeros<T>(size);
+        uint32_t pos = 0;
+        for (size_t i = 0; i < offsets_in.size(); ++i) {
+            uint32_t n = (uint32_t) width(offsets_in[i]);
+            I target = arange<I>(n) + pos;
+            scatter(offsets, offsets_in[i], target);
+            scatter(values, values_in[i], target);
+            pos += n;
+        }
+    } else {
+        values = v->grad;
+    }
+}
+
+template <typename T> void ad_accum_grad_into(uint32_t index, T &target) {
+    if (unlikely(index == 0))
+        return;
+
+    State &state = ad_state(index);
+    StateGuard guard(state);
+    Variable *v = state.find(index);
+    if (!v)
+        ad_raise("ad_accum_grad_into(): referenced an unknown variable a%u!", index);
+
+    if (unlikely((uint32_t) width(target) != v->size))
+        ad_raise("ad_accum_grad_into(): the target has size %zu, but variable "
+                 "a%u has size %u!", width(target), index, v->size);
+
+    PendingGrad *sg = nullptr;
+    if constexpr (is_jit_v<T>) {
+        auto it = state.pending_grads.find(v);
+        if (it != state.pending_grads.end()) {
+            sg = &it.value();
+            sg->reduce_sums(v->grad);
+        }
+    }
+
+    if (is_valid(v->grad))
+        target += v->grad;
+
+    if constexpr (is_jit_v<T>) {
+        if (sg) {
+            for (size_t i = 0; i < sg->offsets.size(); ++i)
+                scatter_reduce(ReduceOp::Add, target, sg->values[i],
+                               sg->offsets[i], sg->masks[i]);
+        }
+    }
 }
 
 template <typename T> void ad_set_label(uint32_t index, const char *label) {
     if (index == 0)
         return;
-    std::lock_guard<std::mutex> guard(state.mutex);
+    State &state = ad_state(index);
+    StateGuard guard(state);
     ad_log(Debug, "ad_set_label(a%u, \"%s\")", index, label ? label : "(null)");
     Variable *v = state[index];
     if (v->free_label)
         free(v->label);
-    v->label = strdup(label);
+
+    // Store the label of the gradient ("<label>_grad") right behind it
+    size_t size = strlen(label);
+    char *value = (char *) malloc_check(2 * size + 7);
+    memcpy(value, label, size + 1);
+    memcpy(value + size + 1, label, size);
+    memcpy(value + 2 * size + 1, "_grad", 6);
+
+    v->label = value;
     v->free_label = true;
     v->custom_label = true;
 }
@@ -1655,7 +2456,8 @@ template <typename T> void ad_set_label(uint32_t index, const char *label) {
 template <typename T> const char *ad_label(uint32_t index) {
     if (index == 0)
         return nullptr;
-    std::lock_guard<std::mutex> guard(state.mutex);
+    State &state = ad_state(index);
+    StateGuard guard(state);
     return state[index]->label;
 }
 
@@ -1670,7 +2472,7 @@ void ad_add_edge(uint32_t source_idx, uint32_t target_idx,
     Scope scope;
 
     if (unlikely(!scopes.empty())) {
-        scope = scopes.back();
+        scope = scopes.back().fork();
         (void) scope.maybe_disable(source_idx);
         (void) scope.maybe_disable(target_idx);
     }
@@ -1678,28 +2480,28 @@ void ad_add_edge(uint32_t source_idx, uint32_t target_idx,
     if (source_idx == 0 || target_idx == 0)
         return;
 
-    std::lock_guard<std::mutex> guard(state.mutex);
+    uint32_t op[2] = { source_idx, target_idx };
+    State &state = ad_state_select("ad_add_edge", op, 2);
+    StateGuard guard(state);
     ad_log(Debug, "ad_add_edge(a%u -> a%u)", source_idx, target_idx);
-    assert(source_idx < target_idx);
 
     Variable *source = state[source_idx],
              *target = state[target_idx];
+    assert(source->counter < target->counter);
 
     uint32_t edge_index_new = ad_edge_new();
     Edge &edge = state.edges[edge_index_new];
     edge.source = source_idx;
     edge.target = target_idx;
 
-    if (callback)
+    if (callback) {
         edge.special = new SpecialCallback<Value>(callback, std::move(scope));
-    else
+        state.stats.callback_edges++;
+    } else
         edge.special = new SpecialConnection<Value>();
 
-    edge.next_fwd = source->next_fwd;
-    edge.next_bwd = target->next_bwd;
-
-    source->next_fwd = edge_index_new;
-    target->next_bwd = edge_index_new;
+    ad_edge_link_fwd(source, edge_index_new);
+    ad_edge_link_bwd(target, edge_index_new);
     ad_inc_ref(source_idx, source);
 }
 
@@ -1708,49 +2510,69 @@ void ad_add_edge(uint32_t source_idx, uint32_t target_idx,
 // Enqueuing of variables and edges
 // ==========================================================================
 
-/// Forward-mode DFS starting from 'index'
+/**
+ * \brief Forward-mode search starting from 'index'
+ *
+ * The newly enqueued part of 'todo' doubles as the work list, which avoids
+ * recursing once per level of long chains. The visiting order is irrelevant
+ * since ad_sort_edges() orders the edges before they are traversed.
+ */
 static void ad_dfs_fwd(std::vector<EdgeRef> &todo, uint32_t index, Variable *v) {
-    DRJIT_MARK_USED(index);
+    State &state = *state_active;
+    size_t pos = todo.size();
 
-    uint32_t edge_id = v->next_fwd;
-    while (edge_id) {
-        Edge &edge = state.edges[edge_id];
+    while (true) {
+        uint32_t edge_id = v->next_fwd;
+        while (edge_id) {
+            Edge &edge = state.edges[edge_id];
 
-        if (!edge.visited) {
-            edge.visited = 1;
+            if (!edge.visited) {
+                edge.visited = 1;
 
-            ad_trace("ad_dfs_fwd(): enqueuing edge a%u -> a%u", index,
-                     edge.target);
+                ad_trace("ad_dfs_fwd(): enqueuing edge a%u -> a%u", index,
+                         edge.target);
 
-            Variable *v2 = state[edge.target];
-            ad_inc_ref(edge.target, v2);
-            todo.emplace_back(edge_id, edge.source, edge.target);
-            ad_dfs_fwd(todo, edge.target, v2);
+                ad_inc_ref(edge.target, state[edge.target]);
+                todo.emplace_back(edge_id, edge.source, edge.target);
+            }
+
+            edge_id = edge.next_fwd;
         }
 
-        edge_id = edge.next_fwd;
+        if (pos == todo.size())
+            break;
+        index = todo[pos++].target;
+        v = state[index];
     }
 }
 
-/// Reverse-mode DFS starting from 'index'
+/// Reverse-mode search starting from 'index', see ad_dfs_fwd()
 static void ad_dfs_bwd(std::vector<EdgeRef> &todo, uint32_t index, Variable *v) {
-    uint32_t edge_id = v->next_bwd;
-    while (edge_id) {
-        Edge &edge = state.edges[edge_id];
+    State &state = *state_active;
+    size_t pos = todo.size();
 
-        if (!edge.visited) {
-            edge.visited = 1;
+    while (true) {
+        uint32_t edge_id = v->next_bwd;
+        while (edge_id) {
+            Edge &edge = state.edges[edge_id];
+
+            if (!edge.visited) {
+                edge.visited = 1;
 
-            ad_trace("ad_dfs_bwd(): enqueuing edge a%u -> a%u", index,
-                     edge.source);
+                ad_trace("ad_dfs_bwd(): enqueuing edge a%u -> a%u", index,
+                         edge.source);
 
-            Variable *v2 = state[edge.source];
-            ad_inc_ref(index, v);
-            todo.emplace_back(edge_id, edge.source, edge.target);
-            ad_dfs_bwd(todo, edge.source, v2);
+                ad_inc_ref(index, v);
+                todo.emplace_back(edge_id, edge.source, edge.target);
+            }
+
+            edge_id = edge.next_bwd;
         }
 
-        edge_id = edge.next_bwd;
+        if (pos == todo.size())
+            break;
+        index = todo[pos++].source;
+        v = state[index];
     }
 }
 
@@ -1763,7 +2585,13 @@ template <typename T> void ad_enqueue(ADMode mode, uint32_t index) {
 
     LocalState &ls = local_state;
 
-    std::lock_guard<std::mutex> guard(state.mutex);
+    if (unlikely(!ls.todo.empty() &&
+                 ad_shard(ls.todo[0].target) != ad_shard(index)))
+        ad_raise("ad_enqueue(): variable a%u belongs to a different AD graph "
+                 "than previously enqueued variables!", index);
+
+    State &state = ad_state(index);
+    StateGuard guard(state);
     switch (mode) {
         case ADMode::Forward:
             ad_dfs_fwd(ls.todo, index, state[index]);
@@ -1782,43 +2610,443 @@ template <typename T> void ad_enqueue(ADMode mode, uint32_t index) {
 // AD graph traversal
 // ==========================================================================
 
-template <typename Value>
-void ad_traverse(ADMode mode, uint32_t flags) {
+/// Propagate the gradient of 'v0' along the edge 'er' to the variable 'v1'
+static void ad_propagate_edge(State &state, const EdgeRef &er, Variable *v0,
+                              Variable *v1, ADMode mode, uint32_t flags) {
+    Edge &edge = state.edges[er.id];
+
+    if (unlikely(v0->custom_label)) {
+        // See ad_set_label() regarding the gradient label
+        if (width(v0->grad) != 0)
+            set_label(v0->grad, v0->label + strlen(v0->label) + 1);
+    }
+
+    if (unlikely(edge.special)) {
+        if (mode == ADMode::Forward)
+            edge.special->forward(v0, v1, flags);
+        else
+            edge.special->backward(v1, v0, flags);
+
+        if (flags & (uint32_t) ADFlag::ClearEdges) {
+            // Edge may have been invalidated by callback, look up once more
+            Edge &edge2 = state.edges[er.id];
+            if (edge2.source == er.source && edge2.target == er.target) {
+                Special *special2 = edge2.special;
+                edge2.special = nullptr;
+                delete special2;
+            }
+        }
+    } else if (edge.identity) {
+        v1->accum(v0->grad, v0->size);
+    } else {
+        v1->mul_accum(v0->grad, edge.weight, v0->size);
+
+        if (flags & (uint32_t) ADFlag::ClearEdges)
+            edge.weight = Value();
+    }
+}
+
+/// Check that the enqueued edge 'er' is still intact before traversing it
+static void ad_check_edge(State &state, const EdgeRef &er, uint32_t &last_edge_id) {
+    const Edge &edge = state.edges[er.id];
+
+    if (unlikely(er.id == last_edge_id))
+        ad_fail("ad_traverse(): internal error: edge a%u -> a%u was "
+                "enqueued twice!", er.source, er.target);
+    last_edge_id = er.id;
+
+    if (unlikely(!edge.visited))
+        ad_fail("ad_traverse(): internal error: edge a%u -> a%u is not "
+                "marked as visited! (1)", er.source, er.target);
+
+    if (unlikely(edge.source != er.source || edge.target != er.target))
+        ad_fail("ad_traverse(): internal error: edge a%u -> a%u was "
+                "garbage collected between enqueuing and traversal steps!",
+                er.source, er.target);
+}
+
+/**
+ * \brief Postpone edges that leave the current dr.isolate_grad() scope
+ *
+ * Returns \c true if the edge was moved to the scope's list of postponed edges
+ * (in which case 'er' is cleared) and should not be traversed now.
+ */
+static bool ad_postpone_edge(EdgeRef &er, uint32_t v0i, const Variable *v0,
+                             uint32_t v1i, const Variable *v1, ADMode mode,
+                             uint64_t postpone_before) {
+    if (likely(v0->counter >= postpone_before))
+        return false;
+
+    if (mode == ADMode::Backward) {
+        ad_trace("ad_traverse(): postponing edge a%u -> a%u due "
+                 "dr.isolate_grad() scope.", v0i, v1i);
+        local_state.scopes.back().postponed.push_back(er);
+        er.id = er.source = er.target = 0;
+        return true;
+    } else if (v1->counter < postpone_before) {
+        ad_raise(
+            "ad_traverse(): tried to forward-propagate derivatives "
+            "across edge a%u -> a%u, which lies outside of the current "
+            "dr.isolate_grad() scope. You must enqueue the variables "
+            "being differentiated and call "
+            "dr.traverse(dr.ADFlag.ClearEdges) *before* entering this "
+            "scope.", v0i, v1i);
+    }
+
+    DRJIT_MARK_USED(v1i);
+    return false;
+}
+
+/// Check the gradient of 'v0', returns \c false if there is nothing to propagate
+static bool ad_check_grad(uint32_t v0i, Variable *v0, uint32_t v1i) {
+    if (unlikely(v0->pending_grad))
+        ad_grad_flush(v0);
+
+    uint32_t grad_size = (uint32_t) width(v0->grad);
+
+    if (unlikely(grad_size != 1 && v0->size != grad_size)) {
+        if (grad_size == 0) {
+            ad_trace("ad_traverse(): skipping edge a%u -> a%u (no source "
+                     "gradient).", v0i, v1i);
+            return false;
+        } else {
+            ad_raise("ad_traverse(): gradient propagation encountered "
+                     "variable a%u (\"%s\") with an invalid gradient size "
+                     "(expected size %u, actual size %u)!",
+                     v0i, v0->label ? v0->label : "", v0->size, grad_size);
+        }
+    }
+
+    DRJIT_MARK_USED(v1i);
+    return true;
+}
+
+/**
+ * \brief Propagate all tangents of 'v0' along the edge 'er' to the variable
+ * 'v1' (used by ad_forward_batch())
+ *
+ * Each direction is temporarily swapped into the 'grad' field of both
+ * variables and then handled by ad_propagate_edge(), which keeps the
+ * per-edge logic in one place. Custom operations access the gradients of
+ * other variables and are therefore not supported (ad_forward_batch() checks
+ * this before the traversal starts).
+ */
+static void ad_propagate_edge_batch(State &state, const EdgeRef &er,
+                                    Variable *v0, Variable *v1, uint32_t flags) {
     LocalState &ls = local_state;
 
-    std::vector<EdgeRef> &todo_tls = ls.todo, todo;
-    if (todo_tls.empty())
-        return;
+    // Look up 't0' after inserting 't1', since insertion may rehash the table
+    std::vector<Value> &t1 = ls.batch[er.target];
+    t1.resize(ls.batch_size);
+    std::vector<Value> &t0 = ls.batch.find(er.source).value();
 
-    // Are we currently recording a megakernel?
-    bool rec = false;
-    if (is_jit_v<Value>)
-        rec = jit_flag(JitFlag::Recording);
-    DRJIT_MARK_USED(rec);
+    // Sparse contributions belong to the regular gradient, not to a tangent
+    if (unlikely(v0->pending_grad))
+        ad_grad_flush(v0);
+    if (unlikely(v1->pending_grad))
+        ad_grad_flush(v1);
 
-    std::lock_guard<std::mutex> guard(state.mutex);
-    todo_tls.swap(todo);
+    // Edges are released once all directions have been processed
+    uint32_t flags_d = flags & ~(uint32_t) ADFlag::ClearEdges;
 
-    if (mode != ADMode::Forward && mode != ADMode::Backward)
-        ad_raise("ad_traverse(): invalid mode specified!");
+    for (size_t i = 0; i < ls.batch_size; ++i) {
+        std::swap(v0->grad, t0[i]);
+        std::swap(v1->grad, t1[i]);
+        if (is_valid(v0->grad) && ad_check_grad(er.source, v0, er.target))
+            ad_propagate_edge(state, er, v0, v1, ADMode::Forward, flags_d);
+        std::swap(v0->grad, t0[i]);
+        std::swap(v1->grad, t1[i]);
+    }
+
+    if (flags & (uint32_t) ADFlag::ClearEdges) {
+        Edge &edge = state.edges[er.id];
+        if (edge.special) {
+            delete edge.special;
+            edge.special = nullptr;
+        } else {
+            edge.weight = Value();
+        }
+    }
+}
+
+/// Traverse the sorted edge list 'todo' one edge at a time
+template <typename Postprocess>
+static void ad_traverse_serial(State &state, std::vector<EdgeRef> &todo,
+                               ADMode mode, uint32_t flags,
+                               uint64_t postpone_before,
+                               const Postprocess &postprocess) {
+    uint32_t v0i_prev = 0;
+    uint32_t last_edge_id = 0;
+    const auto &batch = local_state.batch;
+    bool batched = local_state.batch_size != 0;
+
+    for (EdgeRef &er : todo) {
+        ad_check_edge(state, er, last_edge_id);
+
+        uint32_t v0i = mode == ADMode::Forward ? er.source : er.target,
+                 v1i = mode == ADMode::Forward ? er.target : er.source;
+
+        Variable *v0 = state[v0i],
+                 *v1 = state[v1i];
+
+        if (ad_postpone_edge(er, v0i, v0, v1i, v1, mode, postpone_before))
+            continue;
+
+        if (batched ? batch.find(v0i) == batch.end()
+                    : !ad_check_grad(v0i, v0, v1i))
+            continue;
+
+        postprocess(v0i_prev, v0i);
+        v0i_prev = v0i;
+
+        ad_trace("ad_traverse(): processing edge a%u -> a%u ..", v0i, v1i);
+        if (batched)
+            ad_propagate_edge_batch(state, er, v0, v1, flags);
+        else
+            ad_propagate_edge(state, er, v0, v1, mode, flags);
+    }
+
+    postprocess(v0i_prev, 0);
+}
+
+/// Parallel traversal only pays off for levels with at least this many edges
+constexpr size_t ParallelThreshold = 1024;
+
+/**
+ * \brief Traverse the sorted edge list 'todo' level by level
+ *
+ * The level of an edge is the length of the longest chain of enqueued edges
+ * that must be traversed before the gradient of its origin ('v0') is final.
+ * All edges within a level are therefore independent, except that several of
+ * them may accumulate into the same variable ('v1'). The edges of a level are
+ * grouped by 'v1', and these groups are processed in parallel. Each group is
+ * processed sequentially following the order of 'todo', which makes the
+ * accumulation order independent of the number of threads.
+ *
+ * Special edges may invoke arbitrary callbacks that modify the graph. They
+ * are processed serially after the other edges of their level.
+ */
+template <typename Postprocess>
+static void ad_traverse_levels(State &state, std::vector<EdgeRef> &todo,
+                               ADMode mode, uint32_t flags,
+                               uint64_t postpone_before,
+                               const Postprocess &postprocess) {
+    struct LevelRef {
+        uint32_t level;
+        uint32_t special;
+        uint32_t v1i;
+        uint32_t pos;
+        uint32_t v0i;
+        Variable *v0, *v1;
+
+        bool operator<(const LevelRef &r) const {
+            return std::tie(level, special, v1i, pos) <
+                   std::tie(r.level, r.special, r.v1i, r.pos);
+        }
+    };
+
+    using LevelMap = tsl::robin_map<uint32_t, uint32_t, UInt32Hasher>;
+
+    std::vector<LevelRef> refs;
+    refs.reserve(todo.size());
+    LevelMap levels;
+    uint32_t last_edge_id = 0;
+
+    /* Assign levels. Since 'todo' is topologically sorted, the level of 'v0'
+       is final once the first edge leaving it is encountered */
+    for (uint32_t i = 0; i < (uint32_t) todo.size(); ++i) {
+        EdgeRef &er = todo[i];
+        ad_check_edge(state, er, last_edge_id);
+
+        uint32_t v0i = mode == ADMode::Forward ? er.source : er.target,
+                 v1i = mode == ADMode::Forward ? er.target : er.source;
+
+        Variable *v0 = state[v0i],
+                 *v1 = state[v1i];
+
+        if (ad_postpone_edge(er, v0i, v0, v1i, v1, mode, postpone_before))
+            continue;
+
+        uint32_t level = 0;
+        auto it = levels.find(v0i);
+        if (it != levels.end())
+            level = it->second;
+
+        auto [it2, success] = levels.try_emplace(v1i, level + 1);
+        if (!success && it2->second <= level)
+            it2.value() = level + 1;
+
+        refs.push_back(LevelRef{ level, state.edges[er.id].special ? 1u : 0u,
+                                 v1i, i, v0i, v0, v1 });
+    }
+
+    std::sort(refs.begin(), refs.end());
+
+    ad_log(Debug, "ad_traverse(): processing %zu edges in %u levels ..",
+           refs.size(), refs.empty() ? 0u : refs.back().level + 1);
+
+    std::vector<uint32_t> groups, v0_list;
+    for (size_t start = 0; start < refs.size(); ) {
+        uint32_t level = refs[start].level;
+        size_t end = start;
+        while (end < refs.size() && refs[end].level == level)
+            ++end;
+
+        /* The gradients of all 'v0' of this level are now final. Skip edges
+           without a gradient and split the remainder into groups by 'v1' */
+        groups.clear();
+        v0_list.clear();
+        size_t special_start = end;
+        for (size_t i = start; i < end; ++i) {
+            LevelRef &r = refs[i];
+            v0_list.push_back(r.v0i);
+
+            if (!ad_check_grad(r.v0i, r.v0, r.v1i)) {
+                r.v0 = nullptr;
+                continue;
+            }
+
+            if (r.special) {
+                special_start = std::min(special_start, i);
+                continue;
+            }
+
+            if (groups.empty() || refs[groups.back()].v1i != r.v1i)
+                groups.push_back((uint32_t) i);
+        }
+        groups.push_back((uint32_t) special_start);
+
+        auto process_groups = [&](uint32_t g0, uint32_t g1) {
+            for (uint32_t g = g0; g < g1; ++g) {
+                for (uint32_t i = groups[g]; i < groups[g + 1]; ++i) {
+                    const LevelRef &r = refs[i];
+                    if (r.v0)
+                        ad_propagate_edge(state, todo[r.pos], r.v0, r.v1,
+                                          mode, flags);
+                }
+            }
+        };
+
+        uint32_t group_count = (uint32_t) groups.size() - 1;
+
+        if (group_count > 1 && special_start - start >= ParallelThreshold) {
+            uint32_t block_size =
+                std::max(1u, group_count / (4 * std::max(1u, pool_size())));
+            drjit::parallel_for(
+                drjit::blocked_range<uint32_t>(0, group_count, block_size),
+                [&](drjit::blocked_range<uint32_t> range) {
+                    process_groups(range.begin(), range.end());
+                });
+        } else {
+            process_groups(0, group_count);
+        }
 
-    // Bring the edges into the appropriate order
-    std::sort(todo.begin(), todo.end(), [mode](EdgeRef e1, EdgeRef e2) {
-        if (mode == ADMode::Backward)
-            return std::tie(e1.target, e1.source, e1.id) >
-                   std::tie(e2.target, e2.source, e2.id);
+        // Process special edges, which may invoke callbacks
+        for (size_t i = special_start; i < end; ++i) {
+            const LevelRef &r = refs[i];
+            if (r.v0)
+                ad_propagate_edge(state, todo[r.pos], r.v0, r.v1, mode, flags);
+        }
+
+        // Clear gradients of variables that were fully processed
+        std::sort(v0_list.begin(), v0_list.end());
+        v0_list.erase(std::unique(v0_list.begin(), v0_list.end()), v0_list.end());
+        for (uint32_t v0i : v0_list)
+            postprocess(v0i, 0);
+
+        start = end;
+    }
+}
+
+/// Edge lists below this size are ordered using a comparison-based sort
+constexpr size_t BucketSortThreshold = 512;
+
+/**
+ * \brief Sort the edge list 'todo' by (key, id), ascending in forward mode
+ * and descending in backward mode
+ *
+ * The keys are variable creation counters. These are usually dense, in which
+ * case a counting sort with one bucket per key orders the list in linear
+ * time. Each bucket holds the edges of a single variable, which are
+ * subsequently sorted by ID. Sparse key ranges fall back to std::sort().
+ */
+static void ad_sort_edges(std::vector<EdgeRef> &todo, LocalState &ls, ADMode mode) {
+    bool backward = mode == ADMode::Backward;
+    size_t size = todo.size();
+
+    auto edge_lt = [backward](const EdgeRef &e1, const EdgeRef &e2) {
+        if (backward)
+            return std::tie(e1.key, e1.id) > std::tie(e2.key, e2.id);
         else
-            return std::tie(e1.source, e1.target, e1.id) <
-                   std::tie(e2.source, e2.target, e2.id);
-    });
+            return std::tie(e1.key, e1.id) < std::tie(e2.key, e2.id);
+    };
 
+    uint64_t key_min = (uint64_t) -1, key_max = 0;
+    if (size >= BucketSortThreshold) {
+        for (const EdgeRef &er : todo) {
+            key_min = std::min(key_min, er.key);
+            key_max = std::max(key_max, er.key);
+        }
+    }
+
+    if (size < BucketSortThreshold || key_max - key_min >= 2 * (uint64_t) size) {
+        std::sort(todo.begin(), todo.end(), edge_lt);
+        return;
+    }
+
+    // Rebase the keys so that ascending bucket order yields the requested order
+    auto bucket = [&](const EdgeRef &er) -> size_t {
+        return (size_t) (backward ? key_max - er.key : er.key - key_min);
+    };
+
+    std::vector<uint32_t> &offsets = ls.sort_offsets;
+    std::vector<EdgeRef> &tmp = ls.sort_tmp;
+    offsets.assign((size_t) (key_max - key_min) + 2, 0);
+    tmp.resize(size);
+
+    for (const EdgeRef &er : todo)
+        offsets[bucket(er) + 1]++;
+
+    for (size_t i = 1; i < offsets.size(); ++i)
+        offsets[i] += offsets[i - 1];
+
+    for (const EdgeRef &er : todo)
+        tmp[offsets[bucket(er)]++] = er;
+
+    // Order the edges of each variable by ID
+    for (size_t i = 0; i < size; ) {
+        size_t j = i + 1;
+        while (j < size && tmp[j].key == tmp[i].key)
+            ++j;
+        if (j - i > 1)
+            std::sort(tmp.begin() + i, tmp.begin() + j, edge_lt);
+        i = j;
+    }
+
+    todo.swap(tmp);
+}
+
+/// Propagate derivatives along the sorted edge list 'todo' and release it
+static void ad_traverse_todo(State &state, LocalState &ls,
+                             std::vector<EdgeRef> &todo, ADMode mode,
+                             uint32_t flags) {
     ad_log(Debug, "ad_traverse(): processing %zu edges in %s mode ..", todo.size(),
            mode == ADMode::Forward ? "forward" : "backward");
 
-    /// Any edges with an ID less than this value will be postponed
-    uint32_t postpone_before = 0;
+    struct DepthGuard {
+        uint32_t &depth;
+        DepthGuard(uint32_t &depth) : depth(depth) { depth++; }
+        ~DepthGuard() { depth--; }
+    } depth_guard(ls.traverse_depth);
+
+    auto before = std::chrono::steady_clock::now();
+    state.stats.traversals++;
+    state.stats.edges_traversed += todo.size();
+
+    /// Any edges involving variables created before this counter value will be postponed
+    uint64_t postpone_before = 0;
     if (!ls.scopes.empty() && ls.scopes.back().isolate)
-        postpone_before = ls.scopes.back().variable_index;
+        postpone_before = ls.scopes.back().counter;
 
     std::vector<Value> dr_loop_todo;
     auto postprocess = [&](uint32_t prev_i, uint32_t cur_i) {
@@ -1836,7 +3064,8 @@ void ad_traverse(ADMode mode, uint32_t flags) {
            granularity matching the loop iterations of the original/primal
            evaluation). The code below does just that. */
 
-        bool dr_loop_prev = prev->label && strstr(prev->label, "dr_loop"),
+        bool dr_loop_prev = !ls.batch_size && prev->label &&
+                            strstr(prev->label, "dr_loop"),
              dr_loop_cur  = cur && cur->label && strstr(cur->label, "dr_loop");
 
         if (dr_loop_prev) {
@@ -1863,119 +3092,28 @@ void ad_traverse(ADMode mode, uint32_t flags) {
         /* Don't clear the gradient of vertices created *before* entering
            an dr.isolation() scope, or when their gradient is still explicitly
            referenced by some other part of the computation graph */
-        if (prev_i < postpone_before || prev->ref_count_grad > 0)
+        if (prev->counter < postpone_before || prev->ref_count_grad > 0)
             clear_grad = false;
 
         // Aggressively clear gradients at intermediate nodes
         if (clear_grad) {
             ad_trace("ad_traverse(): clearing gradient at intermediate variable a%u", prev_i);
-            prev->grad = Value();
+            if (ls.batch_size)
+                ls.batch.erase(prev_i);
+            else
+                ad_grad_clear(prev);
         }
     };
 
-    uint32_t v0i_prev = 0;
-    uint32_t last_edge_id = 0;
-
     // This is the main AD traversal loop
-    for (EdgeRef &er : todo) {
-        Edge &edge = state.edges[er.id];
-
-        uint32_t v0i, v1i;
-        if (mode == ADMode::Forward) {
-            v0i = edge.source;
-            v1i = edge.target;
-        } else {
-            v0i = edge.target;
-            v1i = edge.source;
-        }
-
-        if (unlikely(er.id == last_edge_id))
-            ad_fail("ad_traverse(): internal error: edge a%u -> a%u was "
-                    "enqueued twice!", v0i, v1i);
-        last_edge_id = er.id;
-
-        if (unlikely(!edge.visited))
-            ad_fail("ad_traverse(): internal error: edge a%u -> a%u is not "
-                    "marked as visited! (1)", er.source, er.target);
-
-        if (unlikely(edge.source != er.source || edge.target != er.target))
-            ad_fail("ad_traverse(): internal error: edge a%u -> a%u was "
-                    "garbage collected between enqueuing and traversal steps!",
-                    v0i, v1i);
-
-        Variable *v0 = state[v0i],
-                 *v1 = state[v1i];
-
-        uint32_t grad_size = (uint32_t) width(v0->grad);
-
-        if (unlikely(v0i < postpone_before)) {
-            if (mode == ADMode::Backward) {
-                ad_trace("ad_traverse(): postponing edge a%u -> a%u due "
-                         "dr.isolate_grad() scope.", v0i, v1i);
-                ls.scopes.back().postponed.push_back(er);
-                er.id = er.source = er.target = 0;
-                continue;
-            } else if (v1i < postpone_before) {
-                ad_raise(
-                    "ad_traverse(): tried to forward-propagate derivatives "
-                    "across edge a%u -> a%u, which lies outside of the current "
-                    "dr.isolate_grad() scope (a%u .. a%u). You must enqueue "
-                    "the variables being differentiated and call "
-                    "dr.traverse(dr.ADFlag.ClearEdges) *before* entering this "
-                    "scope.",
-                    v0i, v1i, postpone_before, state.variable_index);
-            }
-        }
-
-        if (unlikely(grad_size != 1 && v0->size != grad_size)) {
-            if (grad_size == 0) {
-                ad_trace("ad_traverse(): skipping edge a%u -> a%u (no source "
-                         "gradient).", v0i, v1i);
-                continue;
-            } else {
-                ad_raise("ad_traverse(): gradient propagation encountered "
-                         "variable a%u (\"%s\") with an invalid gradient size "
-                         "(expected size %u, actual size %u)!",
-                         v0i, v0->label ? v0->label : "", v0->size, grad_size);
-            }
-        }
-
-        postprocess(v0i_prev, v0i);
-        v0i_prev = v0i;
-
-        ad_trace("ad_traverse(): processing edge a%u -> a%u ..", v0i, v1i);
+    bool parallel = false;
+    if constexpr (!is_jit_v<Value>)
+        parallel = (flags & (uint32_t) ADFlag::Parallel) && !ls.batch_size;
 
-        if (unlikely(v0->custom_label)) {
-            char tmp[256];
-            snprintf(tmp, 256, "%s_grad", v0->label);
-            if (width(v0->grad) != 0)
-                set_label(v0->grad, tmp);
-        }
-
-        if (unlikely(edge.special)) {
-            if (mode == ADMode::Forward)
-                edge.special->forward(v0, v1, flags);
-            else
-                edge.special->backward(v1, v0, flags);
-
-            if (flags & (uint32_t) ADFlag::ClearEdges) {
-                // Edge may have been invalidated by callback, look up once more
-                Edge &edge2 = state.edges[er.id];
-                if (edge2.source == er.source && edge2.target == er.target) {
-                    Special *special2 = edge2.special;
-                    edge2.special = nullptr;
-                    delete special2;
-                }
-            }
-        } else {
-            v1->mul_accum(v0->grad, edge.weight, v0->size);
-
-            if (flags & (uint32_t) ADFlag::ClearEdges)
-                edge.weight = Value();
-        }
-    }
-
-    postprocess(v0i_prev, 0);
+    if (parallel)
+        ad_traverse_levels(state, todo, mode, flags, postpone_before, postprocess);
+    else
+        ad_traverse_serial(state, todo, mode, flags, postpone_before, postprocess);
 
     ad_log(Debug, (flags & (uint32_t) ADFlag::ClearEdges)
                       ? "ad_traverse(): decreasing reference counts .."
@@ -2004,54 +3142,9 @@ void ad_traverse(ADMode mode, uint32_t flags) {
         if (flags & (uint32_t) ADFlag::ClearEdges) {
             ad_trace("ad_traverse(): removing edge a%u -> a%u", er.source, er.target);
 
-            // Clear out forward edge
-            uint32_t edge_id_prev = 0,
-                     edge_id_cur = source->next_fwd;
-            while (edge_id_cur) {
-                Edge &e2 = state.edges[edge_id_cur];
-                ad_trace("ad_traverse(): visiting forward edge a%u -> a%u", e2.source, e2.target);
-
-                if (edge_id_cur == er.id) {
-                    if (edge_id_prev)
-                        state.edges[edge_id_prev].next_fwd = e2.next_fwd;
-                    else
-                        source->next_fwd = e2.next_fwd;
-                    break;
-                } else if (unlikely(e2.source != er.source)) {
-                    ad_fail("ad_traverse(): invalid forward edge connectivity!");
-                }
-
-                edge_id_prev = edge_id_cur;
-                edge_id_cur = e2.next_fwd;
-            }
-
-            if (unlikely(!edge_id_cur))
-                ad_fail("ad_traverse(): could not find forward edge a%u "
-                        "-> a%u", er.source, er.target);
-
-            // Clear out backward edge
-            edge_id_prev = 0;
-            edge_id_cur = target->next_bwd;
-            while (edge_id_cur) {
-                Edge &e2 = state.edges[edge_id_cur];
-
-                if (edge_id_cur == er.id) {
-                    if (edge_id_prev)
-                        state.edges[edge_id_prev].next_bwd = e2.next_bwd;
-                    else
-                        target->next_bwd = e2.next_bwd;
-                    break;
-                } else if (unlikely(e2.target != er.target)) {
-                    ad_fail("ad_traverse(): invalid backward edge connectivity!");
-                }
-
-                edge_id_prev = edge_id_cur;
-                edge_id_cur = e2.next_bwd;
-            }
-
-            if (unlikely(!edge_id_cur))
-                ad_fail("ad_traverse(): could not find backward edge a%u "
-                        "-> a%u", er.source, er.target);
+            // Clear out forward and backward edge
+            ad_edge_unlink_fwd(source, er.id);
+            ad_edge_unlink_bwd(target, er.id);
 
             // Postpone deallocation of the edge callback, if there is one
             if (unlikely(edge.special))
@@ -2060,7 +3153,6 @@ void ad_traverse(ADMode mode, uint32_t flags) {
             state.unused_edges.push_back(er.id);
 
             ad_dec_ref(er.source, source);
-            target = state[er.target]; // pointer might have changed
         }
 
         ad_dec_ref(er.target, target);
@@ -2080,10 +3172,334 @@ void ad_traverse(ADMode mode, uint32_t flags) {
         temp.swap(cleanup);
     }
 
+    state.stats.traverse_time += ad_seconds_since(before);
+}
+
+/// Store the sorted edge list 'todo' as the schedule of 'tape'
+static void ad_tape_capture(Tape &tape, const std::vector<EdgeRef> &todo,
+                            ADMode mode) {
+    using RankMap = tsl::robin_map<uint32_t, uint32_t, UInt32Hasher>;
+
+    /* Indices may have been reused while the tape was active. Later entries
+       take precedence, since they refer to the edges/variables that exist now */
+    RankMap variable_rank, edge_rank;
+    for (uint32_t i = 0; i < (uint32_t) tape.variables.size(); ++i)
+        variable_rank[tape.variables[i]] = i;
+    for (uint32_t i = 0; i < (uint32_t) tape.edges.size(); ++i)
+        edge_rank[tape.edges[i]] = i;
+
+    auto rank = [](const RankMap &map, uint32_t value, uint32_t bit,
+                   uint32_t &ranked) {
+        auto it = map.find(value);
+        if (it == map.end())
+            return value;
+        ranked |= bit;
+        return it->second;
+    };
+
+    tape.schedule.clear();
+    tape.schedule.reserve(todo.size());
+    for (const EdgeRef &er : todo) {
+        Tape::Ref ref;
+        ref.ranked = 0;
+        ref.id = rank(edge_rank, er.id, 1, ref.ranked);
+        ref.source = rank(variable_rank, er.source, 2, ref.ranked);
+        ref.target = rank(variable_rank, er.target, 4, ref.ranked);
+        tape.schedule.push_back(ref);
+    }
+
+    tape.mode = mode;
+    tape.recorded = true;
+
+    ad_log(Debug, "ad_tape_capture(): captured %zu edges (%zu variables and "
+           "%zu edges were created while the tape was active).",
+           todo.size(), tape.variables.size(), tape.edges.size());
+}
+
+template <typename Value>
+void ad_traverse(ADMode mode, uint32_t flags) {
+    LocalState &ls = local_state;
+
+    std::vector<EdgeRef> &todo_tls = ls.todo, todo;
+    if (todo_tls.empty())
+        return;
+
+    // Are we currently recording a megakernel?
+    bool rec = false;
+    if (is_jit_v<Value>)
+        rec = jit_flag(JitFlag::Recording);
+    DRJIT_MARK_USED(rec);
+
+    // ad_enqueue() ensures that all edges belong to the same graph shard
+    State &state = ad_state(todo_tls[0].source);
+    StateGuard guard(state);
+    todo_tls.swap(todo);
+
+    if (mode != ADMode::Forward && mode != ADMode::Backward)
+        ad_raise("ad_traverse(): invalid mode specified!");
+
+    /* Bring the edges into the appropriate order. Edges are grouped by the
+       variable whose gradient they propagate, which are visited in (reverse)
+       creation order. */
+    for (EdgeRef &er : todo) {
+        const Variable *v0 =
+            state.find(mode == ADMode::Forward ? er.source : er.target);
+        er.key = v0 ? v0->counter : 0;
+    }
+
+    auto before = std::chrono::steady_clock::now();
+    ad_sort_edges(todo, ls, mode);
+    state.stats.sort_time += ad_seconds_since(before);
+
+    /* Only capture the outermost traversal. Nested ones are started by the
+       callbacks of special edges (e.g., CustomOp, checkpoint()) */
+    if (unlikely(ls.tape && !ls.tape->recorded && !ls.traverse_depth))
+        ad_tape_capture(*ls.tape, todo, mode);
+
+    ad_traverse_todo(state, ls, todo, mode, flags);
+
+    todo.clear();
+    todo_tls.swap(todo);
+}
+
+template <typename Value>
+void ad_forward_batch(size_t k, size_t n_in, const uint32_t *in,
+                      const Value *tangents, size_t n_out, const uint32_t *out,
+                      Value *out_tangents, uint32_t flags) {
+    LocalState &ls = local_state;
+
+    if (unlikely(ls.batch_size))
+        ad_raise("ad_forward_batch(): batched traversals cannot be nested!");
+    if (unlikely(!ls.todo.empty()))
+        ad_raise("ad_forward_batch(): there are still edges enqueued for a "
+                 "regular traversal!");
+    if (k == 0 || n_in == 0)
+        return;
+
+    State &state = ad_state_select("ad_forward_batch", in, (uint32_t) n_in);
+    StateGuard guard(state);
+
+    /// Discard the tangent table, also when the traversal fails
+    struct BatchGuard {
+        LocalState &ls;
+        ~BatchGuard() {
+            ls.batch_size = 0;
+            ls.batch.clear();
+        }
+    } batch_guard { ls };
+
+    std::vector<EdgeRef> todo;
+    for (size_t i = 0; i < n_in; ++i) {
+        uint32_t index = in[i];
+        if (!index)
+            continue;
+        ad_dfs_fwd(todo, index, state[index]);
+
+        std::vector<Value> &t = ls.batch[index];
+        t.resize(k);
+        for (size_t j = 0; j < k; ++j) {
+            const Value &value = tangents[i * k + j];
+            t[j] = is_valid(t[j]) ? t[j] + value : value;
+        }
+    }
+
+    /* Reject custom operations before any edge is processed, and undo the
+       steps of ad_dfs_fwd() so that the graph remains usable */
+    for (const EdgeRef &er : todo) {
+        Special *special = state.edges[er.id].special;
+        if (likely(!special || !dynamic_cast<SpecialCallback<Value> *>(special)))
+            continue;
+
+        for (const EdgeRef &er2 : todo) {
+            state.edges[er2.id].visited = 0;
+            ad_dec_ref(er2.target, state[er2.target]);
+        }
+
+        ad_raise("ad_forward_batch(): the edge a%u -> a%u belongs to a custom "
+                 "operation, which does not support batched tangents!",
+                 er.source, er.target);
+    }
+
+    // Protect the tangents of the outputs from ADFlag::ClearInterior
+    for (size_t i = 0; i < n_out; ++i) {
+        Variable *v = out[i] ? state.find(out[i]) : nullptr;
+        if (v)
+            v->ref_count_grad++;
+    }
+
+    for (EdgeRef &er : todo) {
+        const Variable *v0 = state.find(er.source);
+        er.key = v0 ? v0->counter : 0;
+    }
+
+    auto before = std::chrono::steady_clock::now();
+    ad_sort_edges(todo, ls, ADMode::Forward);
+    state.stats.sort_time += ad_seconds_since(before);
+
+    ls.batch_size = k;
+    ad_traverse_todo(state, ls, todo, ADMode::Forward, flags);
+
+    for (size_t i = 0; i < n_out; ++i) {
+        Variable *v = out[i] ? state.find(out[i]) : nullptr;
+        if (v)
+            v->ref_count_grad--;
+
+        auto it = v ? ls.batch.find(out[i]) : ls.batch.end();
+        for (size_t j = 0; j < k; ++j)
+            out_tangents[i * k + j] =
+                it != ls.batch.end() ? it->second[j] : Value();
+    }
+}
+
+// ==========================================================================
+// AD tapes: capture the traversal schedule of a graph and replay it once an
+// identical graph has been constructed again (e.g., in an optimization loop)
+// ==========================================================================
+
+/// Tapes created by ad_tape_new(), indexed by ID (slot 0 is unused)
+static std::vector<std::unique_ptr<Tape>> tapes(1);
+static std::vector<uint32_t> unused_tapes;
+static std::mutex tapes_mutex;
+
+static Tape *ad_tape_lookup(const char *name, uint32_t id) {
+    std::lock_guard<std::mutex> guard(tapes_mutex);
+    if (unlikely(id == 0 || id >= tapes.size() || !tapes[id]))
+        ad_raise("%s(): invalid tape ID %u!", name, id);
+    return tapes[id].get();
+}
+
+template <typename Value> uint32_t ad_tape_new() {
+    std::lock_guard<std::mutex> guard(tapes_mutex);
+    uint32_t id;
+    if (!unused_tapes.empty()) {
+        id = unused_tapes.back();
+        unused_tapes.pop_back();
+    } else {
+        id = (uint32_t) tapes.size();
+        tapes.emplace_back();
+    }
+    tapes[id].reset(new Tape());
+    return id;
+}
+
+template <typename Value> void ad_tape_free(uint32_t id) {
+    Tape *tape = ad_tape_lookup("ad_tape_free", id);
+
+    LocalState &ls = local_state;
+    if (ls.tape == tape)
+        ls.tape = nullptr;
+
+    std::lock_guard<std::mutex> guard(tapes_mutex);
+    tapes[id].reset();
+    unused_tapes.push_back(id);
+}
+
+template <typename Value> void ad_tape_begin(uint32_t id) {
+    Tape *tape = ad_tape_lookup("ad_tape_begin", id);
+
+    LocalState &ls = local_state;
+    if (unlikely(ls.tape))
+        ad_raise("ad_tape_begin(): another tape is already active on this "
+                 "thread!");
+
+    tape->variables.clear();
+    tape->edges.clear();
+    ls.tape = tape;
+}
+
+template <typename Value> void ad_tape_end() {
+    LocalState &ls = local_state;
+    if (unlikely(!ls.tape))
+        ad_raise("ad_tape_end(): no tape is active on this thread!");
+
+    ls.tape->variables.clear();
+    ls.tape->edges.clear();
+    ls.tape = nullptr;
+}
+
+template <typename Value> bool ad_tape_recorded(uint32_t id) {
+    return ad_tape_lookup("ad_tape_recorded", id)->recorded;
+}
+
+template <typename Value> void ad_tape_replay(uint32_t flags) {
+    LocalState &ls = local_state;
+    Tape *tape = ls.tape;
+
+    if (unlikely(!tape))
+        ad_raise("ad_tape_replay(): no tape is active on this thread!");
+    if (unlikely(!tape->recorded))
+        ad_raise("ad_tape_replay(): the active tape has not captured a "
+                 "traversal yet!");
+    if (unlikely(!ls.todo.empty()))
+        ad_raise("ad_tape_replay(): the edges of the captured traversal are "
+                 "enqueued automatically, but other edges were already "
+                 "enqueued!");
+
+    const std::vector<Tape::Ref> &schedule = tape->schedule;
+    if (schedule.empty())
+        return;
+
+    auto resolve = [](uint32_t value, bool ranked,
+                      const std::vector<uint32_t> &list) -> uint32_t {
+        if (!ranked)
+            return value;
+        return value < list.size() ? list[value] : 0;
+    };
+
+    std::vector<EdgeRef> &todo_tls = ls.todo, todo;
+    todo_tls.swap(todo);
+    todo.reserve(schedule.size());
+
+    uint32_t target_0 =
+        resolve(schedule[0].target, schedule[0].ranked & 4, tape->variables);
+    State &state = ad_state(target_0);
+    StateGuard guard(state);
+
+    /* Check that the graph matches the captured one before modifying it.
+       Variables created before ad_tape_begin() (e.g., the parameters of an
+       optimization) may have changed and are taken from the edge. */
+    for (const Tape::Ref &ref : schedule) {
+        uint32_t id     = resolve(ref.id,     ref.ranked & 1, tape->edges),
+                 source = resolve(ref.source, ref.ranked & 2, tape->variables),
+                 target = resolve(ref.target, ref.ranked & 4, tape->variables);
+
+        const Edge *edge =
+            id && id < state.edges.size() ? &state.edges[id] : nullptr;
+
+        if (edge && !(ref.ranked & 2))
+            source = edge->source;
+        if (edge && !(ref.ranked & 4))
+            target = edge->target;
+
+        if (unlikely(!edge || !source || !target || edge->source != source ||
+                     edge->target != target || edge->visited)) {
+            todo.clear();
+            todo_tls.swap(todo);
+            ad_raise("ad_tape_replay(): the AD graph differs from the one "
+                     "captured by the tape (edge a%u -> a%u could not be "
+                     "found)! Tapes can only be replayed when the same "
+                     "sequence of differentiable operations is performed "
+                     "again.", source, target);
+        }
+
+        todo.emplace_back(id, source, target);
+    }
+
+    ad_log(Debug, "ad_tape_replay(): replaying %zu edges ..", todo.size());
+
+    // Perform the steps of ad_enqueue() and ad_traverse()
+    for (const EdgeRef &er : todo) {
+        state.edges[er.id].visited = 1;
+        ad_inc_ref(er.target, state[er.target]);
+    }
+
+    ad_traverse_todo(state, ls, todo, tape->mode, flags);
+
     todo.clear();
     todo_tls.swap(todo);
 }
 
+
 // ==========================================================================
 // Tracking of implicit dependencies. The following functions are used by
 // the implementations of differentiable virtual function calls, to
@@ -2116,7 +3532,9 @@ template <typename Value> void ad_extract_implicit(size_t snapshot, uint32_t *ou
 
     for (size_t i = 0; i < count; ++i) {
         uint32_t index = implicit[snapshot + i].source;
-        if (state.variables.find(index) != state.variables.end())
+        State &state = ad_state(index);
+        StateGuard guard(state);
+        if (state.find(index))
             out[i] = index;
     }
 
@@ -2139,7 +3557,8 @@ template <typename Value> void ad_enqueue_implicit(size_t snapshot) {
     ad_trace("ad_enqueue_implicit(): enqueuing %zu implicit dependencies.",
              size - snapshot);
 
-    std::lock_guard<std::mutex> guard(state.mutex);
+    State &state = ad_state(implicit[snapshot].source);
+    StateGuard guard(state);
     for (size_t i = snapshot; i < implicit.size(); ++i) {
         const EdgeRef &er = implicit[i];
         Edge &e = state.edges[er.id];
@@ -2167,7 +3586,8 @@ template <typename Value> void ad_dequeue_implicit(size_t snapshot) {
     ad_trace("ad_dequeue_implicit(): dequeuing %zu implicit dependencies.",
              size - snapshot);
 
-    std::lock_guard<std::mutex> guard(state.mutex);
+    State &state = ad_state(implicit[snapshot].source);
+    StateGuard guard(state);
     for (size_t i = snapshot; i < implicit.size(); ++i)
         state[implicit[i].source]->ref_count_grad--;
 }
@@ -2177,32 +3597,83 @@ template <typename Value> void ad_dequeue_implicit(size_t snapshot) {
 // ==========================================================================
 
 extern void RENAME(ad_whos)() {
-    std::lock_guard<std::mutex> guard(state.mutex);
+    std::vector<std::pair<uint64_t, uint32_t>> indices;
 
-    std::vector<uint32_t> indices;
-    indices.reserve(state.variables.size());
-    for (auto &kv: state.variables)
-        indices.push_back(kv.first);
-    std::sort(indices.begin(), indices.end());
+    for (State &state : shards) {
+        StateGuard guard(state);
+        if (!state.variable_count)
+            continue;
 
-    for (uint32_t id : indices) {
-        const Variable *v = state[id];
-        buffer.fmt("  %-7i ", id);
-        size_t sz = buffer.fmt("%u", v->ref_count);
-        buffer.fmt("%*s%-12u%-8s\n", 11 - (int) sz, "", v->size,
-                   v->label ? v->label : "");
+        // List variables in creation order
+        indices.clear();
+        indices.reserve(state.variable_count);
+        for (uint32_t i = 1; i < state.variable_slots; ++i) {
+            const Variable *v = state.slot(i);
+            if (v->used)
+                indices.emplace_back(v->counter, state.index(i, v));
+        }
+        std::sort(indices.begin(), indices.end());
+
+        for (auto [counter, id] : indices) {
+            const Variable *v = state[id];
+            buffer.fmt("  %-7i ", id);
+            size_t sz = buffer.fmt("%u", v->ref_count);
+            buffer.fmt("%*s%-12u%-8s\n", 11 - (int) sz, "", v->size,
+                       v->label ? v->label : "");
+        }
+    }
+}
+
+extern void RENAME(ad_stats)(ADStats &stats, bool reset) {
+    for (State &state : shards) {
+        StateGuard guard(state);
+        ADStats &s = state.stats;
+        uint64_t edges_live = state.edges.size() - state.unused_edges.size() - 1;
+
+        if (reset) {
+            // The peak restarts from the number of edges that exist now
+            s = ADStats();
+            s.edges_peak = edges_live;
+            continue;
+        }
+
+        stats.variables_created += s.variables_created;
+        stats.edges_created += s.edges_created;
+        stats.variables_live += state.variable_count;
+        stats.edges_live += edges_live;
+        stats.edges_peak += s.edges_peak;
+        stats.gather_edges += s.gather_edges;
+        stats.scatter_edges += s.scatter_edges;
+        stats.mask_edges += s.mask_edges;
+        stats.callback_edges += s.callback_edges;
+        stats.traversals += s.traversals;
+        stats.edges_traversed += s.edges_traversed;
+        stats.traverse_time += s.traverse_time;
+        stats.sort_time += s.sort_time;
+        stats.lock_contentions += s.lock_contentions;
+        stats.lock_wait_time += s.lock_wait_time;
     }
 }
 
 template <typename Value> const char *ad_graphviz() {
-    std::lock_guard<std::mutex> guard(state.mutex);
+    // Only visualize the graph that receives new variables on this thread
+    State &state = ad_state_local();
+    StateGuard guard(state);
 
-    std::vector<uint32_t> indices;
-    indices.reserve(state.variables.size());
-    for (const auto& it : state.variables)
-        indices.push_back(it.first);
+    // List variables in creation order
+    std::vector<std::pair<uint64_t, uint32_t>> order;
+    order.reserve(state.variable_count);
+    for (uint32_t i = 1; i < state.variable_slots; ++i) {
+        const Variable *v = state.slot(i);
+        if (v->used)
+            order.emplace_back(v->counter, state.index(i, v));
+    }
+    std::sort(order.begin(), order.end());
 
-    std::sort(indices.begin(), indices.end());
+    std::vector<uint32_t> indices;
+    indices.reserve(order.size());
+    for (auto [counter, index] : order)
+        indices.push_back(index);
     buffer.clear();
     buffer.put("digraph {\n"
                    "    rankdir=BT;\n"
@@ -2379,10 +3850,22 @@ template DRJIT_EXPORT uint32_t ad_new<Value>(const char *, size_t, uint32_t,
 template DRJIT_EXPORT Value ad_grad<Value>(uint32_t, bool);
 template DRJIT_EXPORT void ad_set_grad<Value>(uint32_t, const Value &, bool);
 template DRJIT_EXPORT void ad_accum_grad<Value>(uint32_t, const Value &, bool);
+template DRJIT_EXPORT void ad_grad_sparse<Value, Index>(uint32_t, Index &, Value &);
+template DRJIT_EXPORT void ad_accum_grad_into<Value>(uint32_t, Value &);
 template DRJIT_EXPORT void ad_set_label<Value>(uint32_t, const char *);
 template DRJIT_EXPORT const char *ad_label<Value>(uint32_t);
 template DRJIT_EXPORT void ad_enqueue<Value>(ADMode, uint32_t);
 template DRJIT_EXPORT void ad_traverse<Value>(ADMode, uint32_t);
+template DRJIT_EXPORT void ad_forward_batch<Value>(size_t, size_t, const uint32_t *,
+                                                   const Value *, size_t,
+                                                   const uint32_t *, Value *,
+                                                   uint32_t);
+template DRJIT_EXPORT uint32_t ad_tape_new<Value>();
+template DRJIT_EXPORT void ad_tape_free<Value>(uint32_t);
+template DRJIT_EXPORT void ad_tape_begin<Value>(uint32_t);
+template DRJIT_EXPORT void ad_tape_end<Value>();
+template DRJIT_EXPORT bool ad_tape_recorded<Value>(uint32_t);
+template DRJIT_EXPORT void ad_tape_replay<Value>(uint32_t);
 template DRJIT_EXPORT size_t ad_implicit<Value>();
 template DRJIT_EXPORT void ad_extract_implicit<Value>(size_t, uint32_t*);
 template DRJIT_EXPORT void ad_enqueue_implicit<Value>(size_t);
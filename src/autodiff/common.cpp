@@ -4,6 +4,9 @@
 #include <stdio.h>
 #include <stdarg.h>
 #include <stdexcept>
+#include <mutex>
+#include <string>
+#include <unordered_set>
 
 Buffer buffer{0};
 
@@ -115,19 +118,30 @@ namespace drjit {
     namespace detail {
         extern void ad_whos_scalar_f32();
         extern void ad_whos_scalar_f64();
+        extern void ad_stats_scalar_f32(ADStats &, bool);
+        extern void ad_stats_scalar_f64(ADStats &, bool);
 #if defined(DRJIT_ENABLE_JIT)
         extern void ad_whos_cuda_f32();
         extern void ad_whos_cuda_f64();
         extern void ad_whos_llvm_f32();
         extern void ad_whos_llvm_f64();
+        extern void ad_stats_cuda_f32(ADStats &, bool);
+        extern void ad_stats_cuda_f64(ADStats &, bool);
+        extern void ad_stats_llvm_f32(ADStats &, bool);
+        extern void ad_stats_llvm_f64(ADStats &, bool);
 #endif
     }
 
     struct PrefixEntry {
         PrefixEntry *prev;
-        char *value = nullptr;
+        const char *value = nullptr;
     };
 
+    /* Prefixes are interned, so that their addresses identify them when
+       interning labels (see ad_label_intern() in autodiff.cpp) */
+    static std::mutex prefix_mutex;
+    static std::unordered_set<std::string> prefix_table;
+
 #if !defined(_MSC_VER)
     static __thread PrefixEntry *prefix = nullptr;
 #else
@@ -138,10 +152,13 @@ namespace drjit {
         if (strchr(value, '/'))
             throw std::runtime_error(
                 "ad_prefix_push(): may not contain a '/' character!");
-        const char *prev = prefix ? prefix->value : "";
-        size_t size = strlen(prev) + strlen(value) + 2;
-        char *out = (char *) malloc(size);
-        snprintf(out, size, "%s%s%s", prev, prefix ? "/" : "", value);
+        std::string name = prefix ? prefix->value : "";
+        if (prefix)
+            name += '/';
+        name += value;
+
+        std::lock_guard<std::mutex> guard(prefix_mutex);
+        const char *out = prefix_table.insert(std::move(name)).first->c_str();
         prefix = new PrefixEntry{ prefix, out };
     }
 
@@ -149,7 +166,6 @@ namespace drjit {
         PrefixEntry *p = prefix;
         if (p) {
             prefix = p->prev;
-            free(p->value);
             delete p;
         }
     }
@@ -159,6 +175,28 @@ namespace drjit {
         return p ? p->value : nullptr;
     }
 
+#if !defined(_MSC_VER)
+    static __thread bool thread_local_graph = false;
+#else
+    static __declspec(thread) bool thread_local_graph = false;
+#endif
+
+    DRJIT_EXPORT void ad_set_thread_local(bool value) {
+        thread_local_graph = value;
+    }
+
+    DRJIT_EXPORT bool ad_thread_local() {
+        return thread_local_graph;
+    }
+
+    void *(*ad_wait_begin)() = nullptr;
+    void (*ad_wait_end)(void *) = nullptr;
+
+    DRJIT_EXPORT void ad_set_wait_hooks(void *(*begin)(), void (*end)(void *)) {
+        ad_wait_begin = begin;
+        ad_wait_end = end;
+    }
+
     DRJIT_EXPORT const char *ad_whos() {
         buffer.clear();
         buffer.put("\n");
@@ -178,6 +216,30 @@ namespace drjit {
         return buffer.get();
     }
 
+    static void ad_stats_collect(ADStats &stats, bool reset) {
+        detail::ad_stats_scalar_f32(stats, reset);
+        detail::ad_stats_scalar_f64(stats, reset);
+        #if defined(DRJIT_ENABLE_JIT)
+            #if defined(DRJIT_ENABLE_CUDA)
+                detail::ad_stats_cuda_f32(stats, reset);
+                detail::ad_stats_cuda_f64(stats, reset);
+            #endif
+            detail::ad_stats_llvm_f32(stats, reset);
+            detail::ad_stats_llvm_f64(stats, reset);
+        #endif
+    }
+
+    DRJIT_EXPORT ADStats ad_stats() {
+        ADStats stats;
+        ad_stats_collect(stats, false);
+        return stats;
+    }
+
+    DRJIT_EXPORT void ad_stats_reset() {
+        ADStats stats;
+        ad_stats_collect(stats, true);
+    }
+
     namespace detail {
         /// Custom graph edge for implementing custom differentiable operations
         struct DRJIT_EXPORT DiffCallback {
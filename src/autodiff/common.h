@@ -133,6 +133,9 @@ struct UInt32Hasher {
 };
 
 extern Buffer buffer;
+
+/// malloc() variant that terminates the application when out of memory
+extern void *malloc_check(size_t size);
 static constexpr LogLevel Disable = LogLevel::Disable;
 static constexpr LogLevel Error   = LogLevel::Error;
 static constexpr LogLevel Warn    = LogLevel::Warn;
@@ -156,6 +159,12 @@ extern void ad_raise(const char *fmt, ...);
 extern void ad_log(LogLevel level, const char *fmt, ...);
 
 namespace drjit {
+    /// Return the current (interned) label prefix or \c nullptr
     extern const char *ad_prefix();
+    DRJIT_EXPORT bool ad_thread_local();
     DRJIT_EXPORT bool ad_enabled() noexcept;
+
+    /// Hooks around blocking waits for a graph lock (see ad_set_wait_hooks())
+    extern void *(*ad_wait_begin)();
+    extern void (*ad_wait_end)(void *);
 }
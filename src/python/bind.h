@@ -464,6 +464,17 @@ auto bind_full(py::class_<Array> &cls, bool /* scalar_mode */ = false) {
             cls.def("grad_", [](const Array &a) { return a.grad_(); });
             cls.def("set_grad_", [](Array &a, dr::detached_t<Array> &value) { a.set_grad_(value); });
             cls.def("accum_grad_", [](Array &a, dr::detached_t<Array> &value) { a.accum_grad_(value); });
+            cls.def("grad_sparse_", [](const Array &a) {
+                dr::uint32_array_t<dr::detached_t<Array>> offsets;
+                dr::detached_t<Array> values;
+                dr::detail::ad_grad_sparse<dr::detached_t<Array>>(
+                    a.index_ad(), offsets, values);
+                return std::make_pair(offsets, values);
+            });
+            cls.def("accum_grad_into_", [](const Array &a, dr::detached_t<Array> &target) {
+                dr::detail::ad_accum_grad_into<dr::detached_t<Array>>(
+                    a.index_ad(), target);
+            });
             cls.def("set_grad_enabled_", &Array::set_grad_enabled_);
             cls.def("grad_enabled_", &Array::grad_enabled_);
             cls.def("enqueue_", &Array::enqueue_);
@@ -486,7 +497,46 @@ auto bind_full(py::class_<Array> &cls, bool /* scalar_mode */ = false) {
 
             cls.def_static("scope_leave_", [](bool process_postoned) {
                 dr::detail::ad_scope_leave<dr::detached_t<Array>>(process_postoned);
+            }, py::call_guard<py::gil_scoped_release>());
+
+            cls.def_static(
+                "forward_batch_",
+                [](size_t k, const std::vector<uint32_t> &in,
+                   const std::vector<dr::detached_t<Array>> &tangents,
+                   const std::vector<uint32_t> &out, uint32_t flags) {
+                    if (tangents.size() != k * in.size())
+                        throw std::runtime_error(
+                            "forward_batch_(): expected k tangents per input!");
+                    std::vector<dr::detached_t<Array>> result(k * out.size());
+                    dr::detail::ad_forward_batch<dr::detached_t<Array>>(
+                        k, in.size(), in.data(), tangents.data(), out.size(),
+                        out.data(), result.data(), flags);
+                    return result;
+                }, py::call_guard<py::gil_scoped_release>());
+
+            cls.def_static("tape_new_", []() {
+                return dr::detail::ad_tape_new<dr::detached_t<Array>>();
             });
+
+            cls.def_static("tape_free_", [](uint32_t tape) {
+                dr::detail::ad_tape_free<dr::detached_t<Array>>(tape);
+            });
+
+            cls.def_static("tape_begin_", [](uint32_t tape) {
+                dr::detail::ad_tape_begin<dr::detached_t<Array>>(tape);
+            });
+
+            cls.def_static("tape_end_", []() {
+                dr::detail::ad_tape_end<dr::detached_t<Array>>();
+            });
+
+            cls.def_static("tape_recorded_", [](uint32_t tape) {
+                return dr::detail::ad_tape_recorded<dr::detached_t<Array>>(tape);
+            });
+
+            cls.def_static("tape_replay_", [](uint32_t flags) {
+                dr::detail::ad_tape_replay<dr::detached_t<Array>>(flags);
+            }, py::call_guard<py::gil_scoped_release>());
         }
     }
 
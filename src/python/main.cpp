@@ -108,6 +108,8 @@ PYBIND11_MODULE(drjit_ext, m_) {
         .value("ClearInterior", dr::ADFlag::ClearInterior)
         .value("ClearVertices", dr::ADFlag::ClearVertices)
         .value("Default", dr::ADFlag::Default)
+        .value("Parallel", dr::ADFlag::Parallel)
+        .value("CombineGathers", dr::ADFlag::CombineGathers)
         .def(py::self == py::self)
         .def(py::self | py::self)
         .def(int() | py::self)
@@ -170,6 +172,43 @@ PYBIND11_MODULE(drjit_ext, m_) {
     export_llvm_ad(m);
     m.def("ad_whos_str", &dr::ad_whos);
     m.def("ad_whos", []() { py::print(dr::ad_whos()); });
+    m.def("ad_stats", []() {
+        dr::ADStats s = dr::ad_stats();
+        py::dict result;
+        result["variables_created"] = s.variables_created;
+        result["edges_created"] = s.edges_created;
+        result["variables_live"] = s.variables_live;
+        result["edges_live"] = s.edges_live;
+        result["edges_peak"] = s.edges_peak;
+        result["gather_edges"] = s.gather_edges;
+        result["scatter_edges"] = s.scatter_edges;
+        result["mask_edges"] = s.mask_edges;
+        result["callback_edges"] = s.callback_edges;
+        result["traversals"] = s.traversals;
+        result["edges_traversed"] = s.edges_traversed;
+        result["traverse_time"] = s.traverse_time;
+        result["sort_time"] = s.sort_time;
+        result["lock_contentions"] = s.lock_contentions;
+        result["lock_wait_time"] = s.lock_wait_time;
+        return result;
+    });
+    m.def("ad_stats_reset", &dr::ad_stats_reset);
+    m.def("ad_set_thread_local", &dr::ad_set_thread_local);
+    m.def("ad_thread_local", &dr::ad_thread_local);
+
+    /* Release the GIL while waiting for the lock of an AD graph. Its owner
+       may be traversing the graph with the GIL released and need it to
+       invoke a CustomOp callback. */
+    dr::ad_set_wait_hooks(
+        []() -> void * {
+            if (!Py_IsInitialized() || !PyGILState_Check())
+                return nullptr;
+            return PyEval_SaveThread();
+        },
+        [](void *state) {
+            if (state)
+                PyEval_RestoreThread((PyThreadState *) state);
+        });
     array_detail.def("graphviz_ad", [](){
         py::str string = py::str("");
 
@@ -0,0 +1,131 @@
+#include "test.h"
+#include <drjit/autodiff.h>
+#include <drjit/custom.h>
+
+namespace dr = drjit;
+
+using Float = dr::DiffArray<float>;
+
+/// Map 'n' inputs to 'n' outputs through 'depth' layers that mix neighbors
+static std::vector<Float> build(const std::vector<Float> &x, uint32_t depth) {
+    uint32_t n = (uint32_t) x.size();
+    std::vector<Float> layer = x, next(n);
+    for (uint32_t j = 0; j < depth; ++j) {
+        for (uint32_t i = 0; i < n; ++i)
+            next[i] = dr::fmadd(layer[i], dr::sin(layer[(i + 1) % n]), 0.5f);
+        layer.swap(next);
+    }
+    return layer;
+}
+
+/// Compute the Jacobian of build() column by column using regular traversals
+static std::vector<float> jacobian_ref(uint32_t n, uint32_t depth) {
+    std::vector<float> result(n * n);
+    for (uint32_t j = 0; j < n; ++j) {
+        std::vector<Float> x(n);
+        for (uint32_t i = 0; i < n; ++i) {
+            x[i] = 0.1f * (float) (i + 1);
+            dr::enable_grad(x[i]);
+        }
+        std::vector<Float> y = build(x, depth);
+        dr::forward(x[j]);
+        for (uint32_t i = 0; i < n; ++i)
+            result[i * n + j] = dr::grad(y[i]);
+    }
+    return result;
+}
+
+/// Compute the Jacobian of build() with a single batched traversal
+static std::vector<float> jacobian_batch(uint32_t n, uint32_t depth) {
+    std::vector<Float> x(n);
+    std::vector<uint32_t> in(n), out(n);
+    std::vector<float> tangents(n * n, 0.f), out_tangents(n * n);
+
+    for (uint32_t i = 0; i < n; ++i) {
+        x[i] = 0.1f * (float) (i + 1);
+        dr::enable_grad(x[i]);
+        in[i] = x[i].index_ad();
+        tangents[i * n + i] = 1.f;
+    }
+
+    std::vector<Float> y = build(x, depth);
+    for (uint32_t i = 0; i < n; ++i)
+        out[i] = y[i].index_ad();
+
+    dr::detail::ad_forward_batch<float>(
+        n, n, in.data(), tangents.data(), n, out.data(), out_tangents.data(),
+        (uint32_t) dr::ADFlag::Default);
+
+    // The regular gradients are not affected by the batched traversal
+    for (uint32_t i = 0; i < n; ++i)
+        assert(dr::grad(y[i]) == 0.f);
+
+    return out_tangents;
+}
+
+DRJIT_TEST(test01_jacobian) {
+    const uint32_t n = 8, depth = 5;
+    std::vector<float> ref = jacobian_ref(n, depth),
+                       batch = jacobian_batch(n, depth);
+    for (uint32_t i = 0; i < n * n; ++i)
+        assert(std::abs(ref[i] - batch[i]) <= 1e-5f * (1.f + std::abs(ref[i])));
+}
+
+DRJIT_TEST(test02_missing_tangents) {
+    Float x = 2.f, y = 3.f;
+    dr::enable_grad(x);
+    dr::enable_grad(y);
+    Float z = x * y, w = y * 4.f;
+
+    uint32_t in[1] = { x.index_ad() },
+             out[3] = { z.index_ad(), w.index_ad(), x.index_ad() };
+    float tangents[2] = { 1.f, 2.f }, out_tangents[6];
+
+    dr::detail::ad_forward_batch<float>(2, 1, in, tangents, 3, out,
+                                        out_tangents,
+                                        (uint32_t) dr::ADFlag::Default);
+
+    // 'w' does not depend on 'x', and inputs report their own tangents
+    assert(out_tangents[0] == 3.f && out_tangents[1] == 6.f);
+    assert(out_tangents[2] == 0.f && out_tangents[3] == 0.f);
+    assert(out_tangents[4] == 1.f && out_tangents[5] == 2.f);
+}
+
+/// Scales its input by 3, custom operations do not support batched tangents
+struct Scale : dr::CustomOp<Float, Float, Float> {
+    Float eval(const Float &x) override { return x * 3.f; }
+    void forward() override { set_grad_out(grad_in<0>() * 3.f); }
+    void backward() override { set_grad_in<0>(grad_out() * 3.f); }
+    const char *name() const override { return "scale"; }
+};
+
+DRJIT_TEST(test03_custom_op) {
+    Float x = 2.f;
+    dr::enable_grad(x);
+    Float y = x * x, z = dr::custom<Scale>(y), w = z + y;
+
+    uint32_t in[1] = { x.index_ad() }, out[1] = { w.index_ad() };
+    float tangents[2] = { 1.f, 2.f }, out_tangents[2];
+
+    bool raised = false;
+    try {
+        dr::detail::ad_forward_batch<float>(2, 1, in, tangents, 1, out,
+                                            out_tangents,
+                                            (uint32_t) dr::ADFlag::Default);
+    } catch (const std::exception &) {
+        raised = true;
+    }
+    assert(raised);
+
+    // The graph remains intact, and a regular traversal succeeds
+    dr::forward(x);
+    assert(dr::grad(w) == 16.f);
+}
+
+DRJIT_TEST(test04_jacobian_large) {
+    const uint32_t n = 32, depth = 200;
+    std::vector<float> ref = jacobian_ref(n, depth),
+                       batch = jacobian_batch(n, depth);
+    for (uint32_t i = 0; i < n * n; ++i)
+        assert(std::abs(ref[i] - batch[i]) <= 1e-4f * (1.f + std::abs(ref[i])));
+}
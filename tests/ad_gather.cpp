@@ -0,0 +1,47 @@
+#include "test.h"
+#include <drjit/jit.h>
+#include <drjit/autodiff.h>
+
+namespace dr = drjit;
+
+using Float  = dr::DiffArray<dr::LLVMArray<float>>;
+using UInt32 = dr::LLVMArray<uint32_t>;
+
+/**
+ * Gather 'k' times from a small array using 'n' offsets and differentiate.
+ * All scatters of the backward pass hit the same few entries.
+ */
+static Float run(uint32_t k, uint32_t n, bool shared_offsets, bool combine) {
+    const uint32_t size = 64;
+    Float x = dr::zeros<Float>(size);
+    dr::enable_grad(x);
+
+    UInt32 offset = dr::arange<UInt32>(n) % size;
+
+    Float y = 0.f;
+    for (uint32_t i = 0; i < k; ++i) {
+        UInt32 offset_i = shared_offsets ? offset : (offset + i) % size;
+        y += dr::gather<Float>(x, offset_i) * (float) (i + 1);
+    }
+
+    uint32_t flags = (uint32_t) dr::ADFlag::Default;
+    if (combine)
+        flags |= (uint32_t) dr::ADFlag::CombineGathers;
+    dr::backward_from(y, flags);
+    return dr::grad(x);
+}
+
+DRJIT_TEST(test01_gather_contention) {
+    jit_init((uint32_t) JitBackend::LLVM);
+
+    const uint32_t k = 8, n = 1u << 18;
+
+    for (bool shared : { true, false }) {
+        // Without ADFlag::CombineGathers, every gather edge performs its own scatter
+        Float grad_ref = run(k, n, shared, false),
+              grad = run(k, n, shared, true);
+        assert(dr::allclose(grad_ref, grad, 1e-3f));
+    }
+
+    jit_shutdown(1);
+}
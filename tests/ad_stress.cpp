@@ -0,0 +1,227 @@
+#include "test.h"
+#include <drjit/autodiff.h>
+
+namespace dr = drjit;
+
+using Float = dr::DiffArray<float>;
+
+/// Build a graph where 'x' feeds into 'n' separate operations
+static std::vector<Float> fanout(const Float &x, uint32_t n) {
+    std::vector<Float> y;
+    y.reserve(n);
+    for (uint32_t i = 0; i < n; ++i)
+        y.push_back(x * (float) (i % 7 + 1));
+    return y;
+}
+
+DRJIT_TEST(test01_fanout_forward) {
+    const uint32_t n = 100000;
+    Float x = 1.f;
+    dr::enable_grad(x);
+    std::vector<Float> y = fanout(x, n);
+
+    /* Forward traversal removes the edges of 'x' in creation order, which is
+       the worst case for edge lists that must be searched to unlink an edge */
+    dr::forward(x);
+
+    for (uint32_t i = 0; i < n; ++i)
+        assert(dr::grad(y[i]) == (float) (i % 7 + 1));
+}
+
+DRJIT_TEST(test02_fanout_backward) {
+    const uint32_t n = 100000;
+    Float x = 1.f;
+    dr::enable_grad(x);
+    std::vector<Float> y = fanout(x, n);
+
+    Float z = 0.f;
+    for (uint32_t i = 0; i < n; ++i)
+        z += y[i];
+
+    dr::backward(z);
+
+    float expected = 0.f;
+    for (uint32_t i = 0; i < n; ++i)
+        expected += (float) (i % 7 + 1);
+    assert(dr::grad(x) == expected);
+}
+
+DRJIT_TEST(test03_fanout_free) {
+    const uint32_t n = 100000;
+    Float x = 1.f;
+    dr::enable_grad(x);
+    std::vector<Float> y = fanout(x, n);
+
+    // Releasing the outputs in creation order must unlink the edges of 'x'
+    y.clear();
+
+    dr::backward(x);
+    assert(dr::grad(x) == 1.f);
+}
+
+/// Build a layered graph of width 'n' and depth 'depth', return its output
+static Float layered(const Float &x, uint32_t n, uint32_t depth) {
+    std::vector<Float> layer = fanout(x, n), next(n);
+    for (uint32_t j = 0; j < depth; ++j) {
+        for (uint32_t i = 0; i < n; ++i)
+            next[i] = dr::fmadd(layer[i], layer[(i + 1) % n], 0.25f);
+        layer.swap(next);
+    }
+
+    Float z = 0.f;
+    for (uint32_t i = 0; i < n; ++i)
+        z += layer[i] * 1e-3f;
+    return z;
+}
+
+DRJIT_TEST(test04_parallel_traversal) {
+    const uint32_t n = 20000, depth = 4;
+    float grad[2];
+
+    for (int i = 0; i < 2; ++i) {
+        uint32_t flags = (uint32_t) dr::ADFlag::Default;
+        if (i == 1)
+            flags |= (uint32_t) dr::ADFlag::Parallel;
+        Float x = 0.5f;
+        dr::enable_grad(x);
+        Float z = layered(x, n, depth);
+
+        dr::backward_from(z, flags);
+        grad[i] = dr::grad(x);
+    }
+
+    assert(std::abs(grad[0] - grad[1]) <= 1e-4f * std::abs(grad[0]));
+
+    // The accumulation order, and hence the result, does not depend on timing
+    for (int i = 0; i < 3; ++i) {
+        Float x = 0.5f;
+        dr::enable_grad(x);
+        Float z = layered(x, n, depth);
+        dr::backward_from(z, (uint32_t) dr::ADFlag::Default |
+                             (uint32_t) dr::ADFlag::Parallel);
+        assert(dr::grad(x) == grad[1]);
+    }
+}
+
+DRJIT_TEST(test05_enqueue_traverse) {
+    const uint32_t n = 1000000;
+    Float x = 1.f;
+    dr::enable_grad(x);
+    std::vector<Float> y = fanout(x, n);
+
+    /* Enqueue 1M edges in scrambled order, ordering them dominates the cost
+       of the traversal */
+    for (uint32_t i = 0; i < n; ++i) {
+        uint32_t j = (uint32_t) (((uint64_t) i * 7919) % n);
+        dr::set_grad(y[j], 1.f);
+        dr::enqueue(dr::ADMode::Backward, y[j]);
+    }
+    dr::traverse<Float>(dr::ADMode::Backward);
+
+    float expected = 0.f;
+    for (uint32_t i = 0; i < n; ++i)
+        expected += (float) (i % 7 + 1);
+    assert(std::abs(dr::grad(x) - expected) <= 1e-3f * expected);
+}
+
+DRJIT_TEST(test06_stats) {
+    dr::ad_stats_reset();
+
+    Float x = 1.f;
+    dr::enable_grad(x);
+    std::vector<Float> y = fanout(x, 1000);
+
+    dr::ADStats stats = dr::ad_stats();
+    assert(stats.variables_created == 1001);
+    assert(stats.edges_created == 1000);
+    assert(stats.variables_live == 1001);
+    assert(stats.edges_live == 1000);
+    assert(stats.edges_peak == 1000);
+
+    Float z = 0.f;
+    for (const Float &value : y)
+        z += value;
+    y.clear();
+    dr::backward(z);
+
+    stats = dr::ad_stats();
+    assert(stats.traversals == 1);
+    assert(stats.edges_traversed == 2999);
+    assert(stats.edges_live == 0);
+    assert(stats.edges_peak == 2999);
+    assert(stats.traverse_time > 0 && stats.sort_time >= 0);
+
+    dr::ad_stats_reset();
+    stats = dr::ad_stats();
+    assert(stats.variables_created == 0 && stats.traversals == 0);
+    assert(stats.variables_live == 2);
+}
+
+DRJIT_TEST(test07_nested_scopes) {
+    const uint32_t n = 100000, iterations = 1000;
+    std::vector<Float> x(n);
+    std::vector<uint32_t> indices(n);
+    for (uint32_t i = 0; i < n; ++i) {
+        x[i] = (float) i;
+        dr::enable_grad(x[i]);
+        indices[i] = x[i].index_ad();
+    }
+
+    // Disable gradients for 'n' variables, nested scopes inherit this set
+    dr::detail::ad_scope_enter<float>(dr::detail::ADScope::Suspend, n,
+                                      indices.data());
+    assert(!dr::grad_enabled(x[0]));
+
+    for (uint32_t i = 0; i < iterations; ++i) {
+        dr::isolate_grad<Float> guard;
+        assert(!dr::grad_enabled(x[i]));
+    }
+
+    /* Modifying the set in a nested scope must not affect the parent */ {
+        dr::resume_grad<Float> guard(true, x[1]);
+        assert(dr::grad_enabled(x[1]) && !dr::grad_enabled(x[2]));
+    }
+    assert(!dr::grad_enabled(x[1]));
+
+    dr::detail::ad_scope_leave<float>(false);
+    assert(dr::grad_enabled(x[1]));
+}
+
+DRJIT_TEST(test08_prefixed_labels) {
+    const uint32_t n = 1000000;
+    Float x = 1.f;
+    dr::enable_grad(x);
+
+    dr::ad_prefix_push("outer");
+    dr::ad_prefix_push("inner");
+
+    // Labels of variables created under a prefix are shared
+    std::vector<Float> y = fanout(x, n);
+
+    assert(strcmp(y[0].label_(), "outer/inner/mul") == 0);
+    assert(y[0].label_() == y[n - 1].label_());
+
+    dr::ad_prefix_pop();
+    Float z = y[0] * 2.f;
+    assert(strcmp(z.label_(), "outer/mul") == 0);
+    dr::ad_prefix_pop();
+
+    z.set_label_("z");
+    assert(strcmp(z.label_(), "z") == 0);
+    dr::backward(z);
+    assert(dr::grad(x) == 2.f);
+}
+
+DRJIT_TEST(test09_stale_ids) {
+    Float x = 1.f;
+    dr::enable_grad(x);
+
+    // Freed IDs must not alias new variables after a few slot reuses
+    uint32_t stale = 0;
+    for (uint32_t i = 0; i < 64; ++i) {
+        Float y = x * 2.f;
+        assert(y.index_ad() != stale);
+        if (i == 0)
+            stale = y.index_ad();
+    }
+}
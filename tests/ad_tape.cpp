@@ -0,0 +1,142 @@
+#include "test.h"
+#include <drjit/autodiff.h>
+#include <drjit/custom.h>
+
+namespace dr = drjit;
+
+using Float = dr::DiffArray<float>;
+
+/// Build a graph with 'n' layers of width 'width' that depends on 'x'
+static Float build(const Float &x, uint32_t width, uint32_t n) {
+    std::vector<Float> layer(width);
+    for (uint32_t i = 0; i < width; ++i)
+        layer[i] = x * (float) (i + 1);
+
+    for (uint32_t j = 0; j < n; ++j) {
+        for (uint32_t i = 0; i < width; ++i)
+            layer[i] = dr::fmadd(layer[i], 0.5f, layer[(i + 1) % width] * 0.25f);
+    }
+
+    Float y = 0.f;
+    for (uint32_t i = 0; i < width; ++i)
+        y += layer[i];
+    return y;
+}
+
+/// Run 'iterations' optimization steps, optionally using a tape
+static float optimize(bool use_tape, uint32_t iterations, uint32_t width,
+                      uint32_t n) {
+    Float x = 1.f;
+    uint32_t tape = use_tape ? dr::detail::ad_tape_new<float>() : 0;
+
+    for (uint32_t it = 0; it < iterations; ++it) {
+        dr::enable_grad(x);
+        if (tape)
+            dr::detail::ad_tape_begin<float>(tape);
+
+        Float y = build(x, width, n);
+
+        if (tape && dr::detail::ad_tape_recorded<float>(tape)) {
+            dr::set_grad(y, 1.f);
+            dr::detail::ad_tape_replay<float>((uint32_t) dr::ADFlag::Default);
+        } else {
+            dr::backward(y);
+        }
+
+        if (tape)
+            dr::detail::ad_tape_end<float>();
+
+        x = dr::detach(x) - 1e-3f * dr::grad(x);
+    }
+
+    if (tape)
+        dr::detail::ad_tape_free<float>(tape);
+
+    return x.detach_();
+}
+
+DRJIT_TEST(test01_replay) {
+    float ref = optimize(false, 5, 4, 3),
+          value = optimize(true, 5, 4, 3);
+    assert(ref == value);
+}
+
+DRJIT_TEST(test02_replay_mismatch) {
+    uint32_t tape = dr::detail::ad_tape_new<float>();
+    Float x = 1.f;
+    dr::enable_grad(x);
+
+    dr::detail::ad_tape_begin<float>(tape);
+    Float y = x * x;
+    dr::backward(y);
+    dr::detail::ad_tape_end<float>();
+    assert(dr::detail::ad_tape_recorded<float>(tape));
+
+    // A different graph cannot be traversed using the captured schedule
+    dr::detail::ad_tape_begin<float>(tape);
+    Float z = x + 1.f;
+    dr::set_grad(z, 1.f);
+
+    bool raised = false;
+    try {
+        dr::detail::ad_tape_replay<float>((uint32_t) dr::ADFlag::Default);
+    } catch (const std::exception &) {
+        raised = true;
+    }
+    assert(raised);
+    dr::detail::ad_tape_end<float>();
+
+    // The graph remains intact after a failed replay
+    dr::set_grad(x, 0.f);
+    dr::backward(z);
+    assert(dr::grad(x) == 1.f);
+
+    dr::detail::ad_tape_free<float>(tape);
+}
+
+/// Build a chain of 'n' checkpointed functions that depends on 'x'
+static Float build_checkpoint(const Float &x, uint32_t n, bool use_checkpoint) {
+    auto func = [](const Float &v) { return dr::fmadd(v, v, 0.5f) * 0.5f; };
+
+    Float y = x;
+    for (uint32_t j = 0; j < n; ++j)
+        y = use_checkpoint ? dr::checkpoint(func, y) : func(y);
+    return y * 2.f;
+}
+
+DRJIT_TEST(test03_replay_checkpoint) {
+    Float x_ref = 0.5f;
+    dr::enable_grad(x_ref);
+    Float y_ref = build_checkpoint(x_ref, 3, false);
+    dr::backward(y_ref);
+    float grad_ref = dr::grad(x_ref);
+
+    uint32_t tape = dr::detail::ad_tape_new<float>();
+    for (int it = 0; it < 3; ++it) {
+        Float x = 0.5f;
+        dr::enable_grad(x);
+        dr::detail::ad_tape_begin<float>(tape);
+        Float y = build_checkpoint(x, 3, true);
+
+        /* The checkpoints recompute their graph and traverse it during the
+           first traversal, which must not replace the captured schedule */
+        if (it == 0) {
+            dr::backward(y);
+            assert(dr::detail::ad_tape_recorded<float>(tape));
+        } else {
+            dr::set_grad(y, 1.f);
+            dr::detail::ad_tape_replay<float>((uint32_t) dr::ADFlag::Default);
+        }
+        dr::detail::ad_tape_end<float>();
+
+        assert(std::abs(dr::grad(x) - grad_ref) <= 1e-6f);
+    }
+
+    dr::detail::ad_tape_free<float>(tape);
+}
+
+DRJIT_TEST(test04_replay_large) {
+    float ref = optimize(false, 20, 1000, 50),
+          value = optimize(true, 20, 1000, 50);
+    assert(ref == value);
+}
@@ -0,0 +1,98 @@
+#include "test.h"
+#include <drjit/autodiff.h>
+#include <thread>
+
+namespace dr = drjit;
+
+using Float = dr::DiffArray<float>;
+
+/// Build and differentiate a small graph with 'n' nodes, return the gradient
+static float build_and_backward(uint32_t n) {
+    Float x = 1.5f;
+    dr::enable_grad(x);
+
+    Float y = x;
+    for (uint32_t i = 0; i < n; ++i)
+        y = dr::fmadd(y, 0.5f, x);
+
+    dr::backward(y);
+    return dr::grad(x);
+}
+
+/// Run 'iterations' graph constructions on 'threads' threads in parallel
+static void run(uint32_t threads, bool local, uint32_t iterations, uint32_t n) {
+    float expected = build_and_backward(n);
+
+    auto worker = [&]() {
+        dr::ad_set_thread_local(local);
+        for (uint32_t i = 0; i < iterations; ++i) {
+            float value = build_and_backward(n);
+            assert(value == expected);
+            (void) value;
+        }
+        dr::ad_set_thread_local(false);
+    };
+
+    std::vector<std::thread> pool;
+    for (uint32_t i = 0; i < threads; ++i)
+        pool.emplace_back(worker);
+    for (std::thread &t : pool)
+        t.join();
+}
+
+DRJIT_TEST(test01_thread_local_graph) {
+    dr::ad_set_thread_local(true);
+    assert(dr::ad_thread_local());
+
+    Float x = 2.f;
+    dr::enable_grad(x);
+    uint32_t index = x.index_ad();
+    assert(index != 0 && (index & 0x80000000u) != 0);
+
+    Float y = x * x;
+    assert((y.index_ad() & 0x80000000u) != 0);
+    dr::backward(y);
+    assert(dr::grad(x) == 4.f);
+
+    dr::ad_set_thread_local(false);
+    assert(!dr::ad_thread_local());
+
+    // Variables derived from thread-local ones remain in the same graph
+    Float z = x * 3.f;
+    assert((z.index_ad() & 0x80000000u) != 0);
+
+    // .. while new variables are created in the shared graph
+    Float w = 1.f;
+    dr::enable_grad(w);
+    assert((w.index_ad() & 0x80000000u) == 0);
+}
+
+DRJIT_TEST(test02_mix_graphs) {
+    Float x = 1.f;
+    dr::enable_grad(x);
+
+    Float y;
+    std::thread t([&]() {
+        dr::ad_set_thread_local(true);
+        y = 2.f;
+        dr::enable_grad(y);
+    });
+    t.join();
+
+    bool raised = false;
+    try {
+        Float z = x * y;
+    } catch (const std::exception &) {
+        raised = true;
+    }
+    assert(raised);
+}
+
+DRJIT_TEST(test03_threads) {
+    const uint32_t iterations = 200, n = 50;
+
+    for (uint32_t threads : { 1, 2, 4, 8 }) {
+        run(threads, false, iterations, n);
+        run(threads, true, iterations, n);
+    }
+}
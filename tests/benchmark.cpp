@@ -0,0 +1,670 @@
+/*
+    tests/benchmark.cpp -- Timings of performance-sensitive code paths
+
+    The unit tests only check the correctness of these code paths. This
+    executable is built alongside them, but it is not registered with ctest.
+*/
+
+#include "test.h"
+#include <drjit/vcall.h>
+#include <drjit/jit.h>
+#include <drjit/autodiff.h>
+#include <drjit/random.h>
+#include <drjit/half.h>
+#include <drjit/dynamic.h>
+#include <drjit/scan.h>
+#include <chrono>
+#include <thread>
+#include <numeric>
+#include <memory>
+
+namespace dr = drjit;
+
+using FloatD = dr::DiffArray<float>;
+
+/// Simple stopwatch that reports the elapsed time in milliseconds
+struct Timer {
+    using Clock = std::chrono::high_resolution_clock;
+
+    double value() const {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    Clock::time_point start = Clock::now();
+};
+
+// -----------------------------------------------------------------------
+//! Thread-local AD graphs (see ad_threads.cpp)
+// -----------------------------------------------------------------------
+
+/// Build and differentiate a small graph with 'n' nodes, return the gradient
+static float build_and_backward(uint32_t n) {
+    FloatD x = 1.5f;
+    dr::enable_grad(x);
+
+    FloatD y = x;
+    for (uint32_t i = 0; i < n; ++i)
+        y = dr::fmadd(y, 0.5f, x);
+
+    dr::backward(y);
+    return dr::grad(x);
+}
+
+/// Time 'iterations' graph constructions on 'threads' threads in parallel
+static double run_threads(uint32_t threads, bool local, uint32_t iterations,
+                          uint32_t n) {
+    auto worker = [&]() {
+        dr::ad_set_thread_local(local);
+        for (uint32_t i = 0; i < iterations; ++i)
+            build_and_backward(n);
+        dr::ad_set_thread_local(false);
+    };
+
+    Timer timer;
+    std::vector<std::thread> pool;
+    for (uint32_t i = 0; i < threads; ++i)
+        pool.emplace_back(worker);
+    for (std::thread &t : pool)
+        t.join();
+
+    return timer.value() * 1e-3;
+}
+
+DRJIT_TEST(ad_threads) {
+    const uint32_t iterations = 2000, n = 50;
+
+    for (uint32_t threads : { 1, 2, 4, 8 }) {
+        double shared = run_threads(threads, false, iterations, n),
+               local  = run_threads(threads, true, iterations, n);
+
+        double count = (double) threads * iterations * n;
+        printf("\n  %u thread(s): shared graph %.2f M nodes/s, "
+               "thread-local graphs %.2f M nodes/s", threads,
+               count / shared * 1e-6, count / local * 1e-6);
+    }
+    printf("\n  ");
+}
+
+// -----------------------------------------------------------------------
+//! Large AD graphs (see ad_stress.cpp)
+// -----------------------------------------------------------------------
+
+/// Build a graph where 'x' feeds into 'n' separate operations
+static std::vector<FloatD> fanout(const FloatD &x, uint32_t n) {
+    std::vector<FloatD> y;
+    y.reserve(n);
+    for (uint32_t i = 0; i < n; ++i)
+        y.push_back(x * (float) (i % 7 + 1));
+    return y;
+}
+
+DRJIT_TEST(ad_stress_fanout) {
+    const uint32_t n = 100000;
+
+    /* Forward traversal removes the edges of 'x' in creation order, which is
+       the worst case for edge lists that must be searched to unlink an edge */ {
+        FloatD x = 1.f;
+        dr::enable_grad(x);
+        std::vector<FloatD> y = fanout(x, n);
+
+        Timer timer;
+        dr::forward(x);
+        printf("[forward: %.1f ms] ", timer.value());
+    }
+
+    /* Backward traversal */ {
+        FloatD x = 1.f;
+        dr::enable_grad(x);
+        std::vector<FloatD> y = fanout(x, n);
+
+        FloatD z = 0.f;
+        for (uint32_t i = 0; i < n; ++i)
+            z += y[i];
+
+        Timer timer;
+        dr::backward(z);
+        printf("[backward: %.1f ms] ", timer.value());
+    }
+
+    /* Releasing the outputs in creation order */ {
+        FloatD x = 1.f;
+        dr::enable_grad(x);
+        std::vector<FloatD> y = fanout(x, n);
+
+        Timer timer;
+        y.clear();
+        printf("[free: %.1f ms] ", timer.value());
+    }
+}
+
+/// Build a layered graph of width 'n' and depth 'depth', return its output
+static FloatD layered(const FloatD &x, uint32_t n, uint32_t depth) {
+    std::vector<FloatD> layer = fanout(x, n), next(n);
+    for (uint32_t j = 0; j < depth; ++j) {
+        for (uint32_t i = 0; i < n; ++i)
+            next[i] = dr::fmadd(layer[i], layer[(i + 1) % n], 0.25f);
+        layer.swap(next);
+    }
+
+    FloatD z = 0.f;
+    for (uint32_t i = 0; i < n; ++i)
+        z += layer[i] * 1e-3f;
+    return z;
+}
+
+DRJIT_TEST(ad_stress_parallel_traversal) {
+    const uint32_t n = 20000, depth = 4;
+
+    for (int i = 0; i < 2; ++i) {
+        uint32_t flags = (uint32_t) dr::ADFlag::Default;
+        if (i == 1)
+            flags |= (uint32_t) dr::ADFlag::Parallel;
+        FloatD x = 0.5f;
+        dr::enable_grad(x);
+        FloatD z = layered(x, n, depth);
+
+        Timer timer;
+        dr::backward_from(z, flags);
+        printf("[%s: %.1f ms] ", i == 0 ? "serial" : "parallel", timer.value());
+    }
+}
+
+DRJIT_TEST(ad_stress_enqueue_traverse) {
+    const uint32_t n = 1000000;
+    FloatD x = 1.f;
+    dr::enable_grad(x);
+    std::vector<FloatD> y = fanout(x, n);
+
+    // Enqueue 1M edges in scrambled order
+    Timer timer;
+    for (uint32_t i = 0; i < n; ++i) {
+        uint32_t j = (uint32_t) (((uint64_t) i * 7919) % n);
+        dr::set_grad(y[j], 1.f);
+        dr::enqueue(dr::ADMode::Backward, y[j]);
+    }
+    double enqueue_time = timer.value();
+
+    timer = Timer();
+    dr::traverse<FloatD>(dr::ADMode::Backward);
+    printf("[enqueue: %.1f ms, traverse: %.1f ms] ", enqueue_time, timer.value());
+}
+
+DRJIT_TEST(ad_stress_stats) {
+    FloatD x = 1.f;
+    dr::enable_grad(x);
+    std::vector<FloatD> y = fanout(x, 100000);
+
+    FloatD z = 0.f;
+    for (const FloatD &value : y)
+        z += value;
+    y.clear();
+
+    dr::ad_stats_reset();
+    dr::backward(z);
+
+    dr::ADStats stats = dr::ad_stats();
+    printf("[%zu edges, traverse: %.2f ms, sort: %.2f ms] ",
+           (size_t) stats.edges_traversed, stats.traverse_time * 1e3,
+           stats.sort_time * 1e3);
+}
+
+DRJIT_TEST(ad_stress_nested_scopes) {
+    const uint32_t n = 100000, iterations = 1000;
+    std::vector<FloatD> x(n);
+    std::vector<uint32_t> indices(n);
+    for (uint32_t i = 0; i < n; ++i) {
+        x[i] = (float) i;
+        dr::enable_grad(x[i]);
+        indices[i] = x[i].index_ad();
+    }
+
+    // Nested scopes inherit the set of 'n' disabled variables
+    dr::detail::ad_scope_enter<float>(dr::detail::ADScope::Suspend, n,
+                                      indices.data());
+
+    Timer timer;
+    for (uint32_t i = 0; i < iterations; ++i)
+        dr::isolate_grad<FloatD> guard;
+    printf("[%u nested scopes: %.2f ms] ", iterations, timer.value());
+
+    dr::detail::ad_scope_leave<float>(false);
+}
+
+DRJIT_TEST(ad_stress_prefixed_labels) {
+    const uint32_t n = 1000000;
+    FloatD x = 1.f;
+    dr::enable_grad(x);
+
+    dr::ad_prefix_push("outer");
+    dr::ad_prefix_push("inner");
+
+    Timer timer;
+    std::vector<FloatD> y = fanout(x, n);
+    printf("[%.1f ms] ", timer.value());
+
+    dr::ad_prefix_pop();
+    dr::ad_prefix_pop();
+}
+
+// -----------------------------------------------------------------------
+//! AD tapes (see ad_tape.cpp)
+// -----------------------------------------------------------------------
+
+/// Build a graph with 'n' layers of width 'width' that depends on 'x'
+static FloatD build_layers(const FloatD &x, uint32_t width, uint32_t n) {
+    std::vector<FloatD> layer(width);
+    for (uint32_t i = 0; i < width; ++i)
+        layer[i] = x * (float) (i + 1);
+
+    for (uint32_t j = 0; j < n; ++j) {
+        for (uint32_t i = 0; i < width; ++i)
+            layer[i] = dr::fmadd(layer[i], 0.5f, layer[(i + 1) % width] * 0.25f);
+    }
+
+    FloatD y = 0.f;
+    for (uint32_t i = 0; i < width; ++i)
+        y += layer[i];
+    return y;
+}
+
+/// Time the backward traversals of 'iterations' optimization steps
+static double optimize_tape(bool use_tape, uint32_t iterations, uint32_t width,
+                            uint32_t n) {
+    FloatD x = 1.f;
+    uint32_t tape = use_tape ? dr::detail::ad_tape_new<float>() : 0;
+    double elapsed = 0.0;
+
+    for (uint32_t it = 0; it < iterations; ++it) {
+        dr::enable_grad(x);
+        if (tape)
+            dr::detail::ad_tape_begin<float>(tape);
+
+        FloatD y = build_layers(x, width, n);
+
+        Timer timer;
+        if (tape && dr::detail::ad_tape_recorded<float>(tape)) {
+            dr::set_grad(y, 1.f);
+            dr::detail::ad_tape_replay<float>((uint32_t) dr::ADFlag::Default);
+        } else {
+            dr::backward(y);
+        }
+        elapsed += timer.value();
+
+        if (tape)
+            dr::detail::ad_tape_end<float>();
+
+        x = dr::detach(x) - 1e-3f * dr::grad(x);
+    }
+
+    if (tape)
+        dr::detail::ad_tape_free<float>(tape);
+
+    return elapsed;
+}
+
+DRJIT_TEST(ad_tape_replay) {
+    double time_ref = optimize_tape(false, 20, 1000, 50),
+           time_tape = optimize_tape(true, 20, 1000, 50);
+    printf("[traversal: %.1f ms, with tape: %.1f ms] ", time_ref, time_tape);
+}
+
+// -----------------------------------------------------------------------
+//! Batched forward-mode traversals (see ad_batch.cpp)
+// -----------------------------------------------------------------------
+
+/// Map 'n' inputs to 'n' outputs through 'depth' layers that mix neighbors
+static std::vector<FloatD> build_mix(const std::vector<FloatD> &x,
+                                     uint32_t depth) {
+    uint32_t n = (uint32_t) x.size();
+    std::vector<FloatD> layer = x, next(n);
+    for (uint32_t j = 0; j < depth; ++j) {
+        for (uint32_t i = 0; i < n; ++i)
+            next[i] = dr::fmadd(layer[i], dr::sin(layer[(i + 1) % n]), 0.5f);
+        layer.swap(next);
+    }
+    return layer;
+}
+
+DRJIT_TEST(ad_batch_jacobian) {
+    const uint32_t n = 32, depth = 200;
+    std::vector<FloatD> x(n);
+    std::vector<uint32_t> in(n), out(n);
+    std::vector<float> tangents(n * n, 0.f), out_tangents(n * n);
+
+    // Column by column using regular traversals
+    Timer timer;
+    for (uint32_t j = 0; j < n; ++j) {
+        for (uint32_t i = 0; i < n; ++i) {
+            x[i] = 0.1f * (float) (i + 1);
+            dr::enable_grad(x[i]);
+        }
+        std::vector<FloatD> y = build_mix(x, depth);
+        dr::forward(x[j]);
+    }
+    double time_ref = timer.value();
+
+    // A single batched traversal
+    timer = Timer();
+    for (uint32_t i = 0; i < n; ++i) {
+        x[i] = 0.1f * (float) (i + 1);
+        dr::enable_grad(x[i]);
+        in[i] = x[i].index_ad();
+        tangents[i * n + i] = 1.f;
+    }
+    std::vector<FloatD> y = build_mix(x, depth);
+    for (uint32_t i = 0; i < n; ++i)
+        out[i] = y[i].index_ad();
+    dr::detail::ad_forward_batch<float>(
+        n, n, in.data(), tangents.data(), n, out.data(), out_tangents.data(),
+        (uint32_t) dr::ADFlag::Default);
+    double time_batch = timer.value();
+
+    printf("[column by column: %.1f ms, batched: %.1f ms] ", time_ref,
+           time_batch);
+}
+
+// -----------------------------------------------------------------------
+//! Gradients of gathers with many repeated offsets (see ad_gather.cpp)
+// -----------------------------------------------------------------------
+
+using FloatJ  = dr::DiffArray<dr::LLVMArray<float>>;
+using UInt32J = dr::LLVMArray<uint32_t>;
+
+/// Time the backward pass of 'k' gathers from a small array using 'n' offsets
+static double run_gather(uint32_t k, uint32_t n, bool shared_offsets,
+                         bool combine) {
+    const uint32_t size = 64;
+    FloatJ x = dr::zeros<FloatJ>(size);
+    dr::enable_grad(x);
+
+    UInt32J offset = dr::arange<UInt32J>(n) % size;
+
+    FloatJ y = 0.f;
+    for (uint32_t i = 0; i < k; ++i) {
+        UInt32J offset_i = shared_offsets ? offset : (offset + i) % size;
+        y += dr::gather<FloatJ>(x, offset_i) * (float) (i + 1);
+    }
+
+    Timer timer;
+    uint32_t flags = (uint32_t) dr::ADFlag::Default;
+    if (combine)
+        flags |= (uint32_t) dr::ADFlag::CombineGathers;
+    dr::backward_from(y, flags);
+    FloatJ grad = dr::grad(x);
+    dr::eval(grad);
+    dr::sync_thread();
+
+    return timer.value();
+}
+
+DRJIT_TEST(ad_gather_contention) {
+    jit_init((uint32_t) JitBackend::LLVM);
+
+    const uint32_t k = 8, n = 1u << 22;
+
+    for (bool shared : { true, false }) {
+        double time[2];
+
+        // The first run of each configuration compiles the kernels
+        for (int i = 0; i < 2; ++i) {
+            run_gather(k, n, shared, i == 1);
+            time[i] = run_gather(k, n, shared, i == 1);
+        }
+
+        printf("[%s offsets: separate scatters %.1f ms, combined %.1f ms] ",
+               shared ? "shared" : "distinct", time[0], time[1]);
+    }
+
+    jit_shutdown(1);
+}
+
+// -----------------------------------------------------------------------
+//! Virtual function calls (see vcall.cpp)
+// -----------------------------------------------------------------------
+
+struct BaseJ {
+    BaseJ() {
+        x = 10.f;
+        dr::enable_grad(x);
+    }
+    virtual ~BaseJ() { }
+    virtual FloatJ f(const FloatJ &m) = 0;
+    DRJIT_VCALL_REGISTER(FloatJ, BaseJ)
+    FloatJ x;
+};
+
+struct AJ : BaseJ {
+    FloatJ f(const FloatJ &m) override { return m * x; }
+};
+
+struct BJ : BaseJ {
+    FloatJ f(const FloatJ &m) override { return m + x; }
+};
+
+DRJIT_VCALL_BEGIN(BaseJ)
+DRJIT_VCALL_METHOD(f)
+DRJIT_VCALL_END(BaseJ)
+
+using BasePtrJ = dr::replace_scalar_t<FloatJ, BaseJ *>;
+using UInt32JD = dr::DiffArray<UInt32J>;
+
+DRJIT_TEST(vcall_ad_bwd_many_instances) {
+    jit_init((uint32_t) JitBackend::LLVM);
+
+    const uint32_t n_inst = 1000, n = 10000, iterations = 5;
+    jit_set_flag(JitFlag::VCallRecord, true);
+    jit_set_flag(JitFlag::VCallOptimize, true);
+
+    std::vector<BaseJ *> inst(n_inst);
+    for (uint32_t i = 0; i < n_inst; ++i)
+        inst[i] = (i & 1) ? (BaseJ *) new AJ() : (BaseJ *) new BJ();
+
+    UInt32JD idx = dr::arange<UInt32JD>(n) % n_inst;
+    BasePtrJ arr = dr::select(dr::eq(idx, 0u), inst[0], inst[1]);
+    for (uint32_t i = 2; i < n_inst; ++i)
+        arr = dr::select(dr::eq(idx, i), inst[i], arr);
+    dr::eval(arr);
+
+    // The first iteration compiles the kernels
+    for (uint32_t it = 0; it < iterations; ++it) {
+        FloatJ input = dr::full<FloatJ>(1.f, n);
+        dr::enable_grad(input);
+
+        Timer timer;
+        FloatJ output = arr->f(input);
+        dr::backward(output);
+
+        dr::LLVMArray<float> grad_in = dr::grad(input);
+        dr::eval(grad_in);
+        jit_sync_thread();
+        printf("%s%.1f ms", it == 0 ? "[" : ", ", timer.value());
+    }
+    printf("] ");
+
+    for (BaseJ *p : inst)
+        delete p;
+    jit_shutdown(1);
+}
+
+using FloatP = Packet<float>;
+using MaskP  = mask_t<FloatP>;
+
+struct BaseP {
+    virtual ~BaseP() { }
+    virtual FloatP f(const FloatP &x, MaskP active = true) const = 0;
+    DRJIT_VCALL_REGISTER(FloatP, BaseP)
+};
+
+struct ScaleP : BaseP {
+    ScaleP(float scale) : scale(scale) { }
+    FloatP f(const FloatP &x, MaskP active) const override {
+        return select(active, x * scale, 0.f);
+    }
+    float scale;
+};
+
+DRJIT_VCALL_BEGIN(BaseP)
+DRJIT_VCALL_METHOD(f)
+DRJIT_VCALL_END(BaseP)
+
+using BasePtrP = replace_scalar_t<FloatP, BaseP *>;
+
+DRJIT_TEST(vcall_packet_divergent) {
+    const size_t n = FloatP::Size, iterations = 1000000;
+    std::vector<BaseP *> inst;
+    for (size_t i = 0; i < n; ++i)
+        inst.push_back(new ScaleP(float(i + 1)));
+
+    for (size_t distinct = 1; distinct <= n; distinct *= 2) {
+        // Lane 'i' refers to instance 'i % distinct', every third lane is null
+        BasePtrP self;
+        for (size_t i = 0; i < n; ++i)
+            self.entry(i) = (i % 3 == 2) ? nullptr : inst[i % distinct];
+        MaskP active = neq(arange<FloatP>(), 5.f);
+
+        // Each distinct instance costs one full-width call
+        FloatP x = arange<FloatP>() + 1.f;
+        Timer timer;
+        for (size_t it = 0; it < iterations; ++it)
+            x = self->f(x, active) * (1.f / n) + 1.f;
+        double time = timer.value();
+
+        // Use the result so that the calls are not optimized away
+        assert(all(x >= 1.f));
+        printf("\n  %zu distinct instance(s): %.2f ns/call", distinct,
+               time * 1e6 / iterations);
+    }
+    printf("\n  ");
+
+    for (BaseP *p : inst)
+        delete p;
+}
+
+// -----------------------------------------------------------------------
+//! Packet scatter-reductions (see memory.cpp)
+// -----------------------------------------------------------------------
+
+DRJIT_TEST(packet_scatter_reduce) {
+    using UInt32 = Packet<uint32_t>;
+    using RNG    = PCG32<UInt32>;
+    using UInt64 = RNG::UInt64;
+
+    // Benchmark the reductions for different index collision rates
+    const ReduceOp ops[] = { ReduceOp::Add, ReduceOp::Mul, ReduceOp::Min,
+                             ReduceOp::Max, ReduceOp::And, ReduceOp::Or };
+    const char *op_names[] = { "add", "mul", "min", "max", "and", "or" };
+    std::vector<uint32_t> target(1024 * 1024);
+
+    for (uint32_t target_count : { 1u, 16u, 1024u, 1024u * 1024u }) {
+        printf("\n  targets=%u:", target_count);
+        for (size_t k = 0; k < 6; ++k) {
+            RNG rng(PCG32_DEFAULT_STATE, arange<UInt64>());
+            std::fill(target.begin(), target.end(), 1u);
+
+            Timer timer;
+            for (size_t i = 0; i < 1024 * 1024; ++i) {
+                UInt32 value = rng.next_uint32(),
+                       idx   = rng.next_uint32_bounded(target_count);
+                scatter_reduce(ops[k], target.data(), value | 1u, idx);
+            }
+            printf(" %s=%.1f ms", op_names[k], timer.value());
+        }
+    }
+    printf("\n  ");
+}
+
+// -----------------------------------------------------------------------
+//! Half precision conversions (see float.cpp)
+// -----------------------------------------------------------------------
+
+DRJIT_TEST(packet_load_f16) {
+    using FloatP = Packet<float>;
+    using HalfP  = replace_scalar_t<FloatP, half>;
+    constexpr size_t Size = FloatP::Size;
+
+    // Throughput of loads from half vs. single precision buffers
+    const size_t n = 1024 * 1024;
+    std::vector<half> buf_h(n, half(1.f));
+    std::vector<float> buf_f(n, 1.f);
+    FloatP accum_h = 0.f, accum_f = 0.f;
+
+    Timer timer;
+    for (size_t i = 0; i + Size <= n; i += Size)
+        accum_h += FloatP(load<HalfP>(buf_h.data() + i));
+    double time_h = timer.value();
+
+    timer = Timer();
+    for (size_t i = 0; i + Size <= n; i += Size)
+        accum_f += load<FloatP>(buf_f.data() + i);
+    double time_f = timer.value();
+
+    // Use the results so that the loops are not optimized away
+    printf("[half: %.2f ms, float: %.2f ms, sum: %.0f] ", time_h, time_f,
+           sum(accum_h + accum_f));
+}
+
+// -----------------------------------------------------------------------
+//! Prefix sums (see horiz.cpp)
+// -----------------------------------------------------------------------
+
+DRJIT_TEST(prefix_sum_dynamic) {
+    using FloatX = DynamicArray<float>;
+
+    const size_t n = 1000003;
+    FloatX x = empty<FloatX>(n), out = empty<FloatX>(n);
+    for (size_t i = 0; i < n; ++i)
+        x.entry(i) = float(i % 7);
+
+    // Write to the output array once so that no variant pays for page faults
+    prefix_sum(x.data(), out.data(), n);
+
+    // Report the fastest of several runs, single runs are noisy
+    auto best_of = [](auto func) {
+        double best = 0.0;
+        for (int i = 0; i < 10; ++i) {
+            Timer timer;
+            func();
+            double value = timer.value();
+            best = i == 0 ? value : std::min(best, value);
+        }
+        return best;
+    };
+
+    // Keeps the compiler from discarding results that are otherwise unused
+    volatile float sink;
+
+    for (int exclusive = 0; exclusive < 2; ++exclusive) {
+        double time_dynamic = best_of([&] {
+            FloatX r = prefix_sum(x, exclusive != 0);
+            sink = r.entry(n - 1);
+        });
+
+        double time_packet = best_of([&] {
+            prefix_sum(x.data(), out.data(), n, exclusive != 0);
+        });
+
+        double time_std = best_of([&] {
+            if (exclusive)
+                std::exclusive_scan(x.data(), x.data() + n, out.data(), 0.f);
+            else
+                std::inclusive_scan(x.data(), x.data() + n, out.data());
+        });
+
+        // Like DynamicArray, write to a newly allocated array
+        double time_std_new = best_of([&] {
+            std::unique_ptr<float[]> out_new(new float[n]);
+            if (exclusive)
+                std::exclusive_scan(x.data(), x.data() + n, out_new.get(), 0.f);
+            else
+                std::inclusive_scan(x.data(), x.data() + n, out_new.get());
+            sink = out_new[n - 1];
+        });
+
+        printf("\n  %s: DynamicArray %.2f ms, drjit/scan.h %.2f ms, "
+               "std::%s_scan %.2f ms (%.2f ms incl. allocation)",
+               exclusive ? "exclusive" : "inclusive", time_dynamic,
+               time_packet, exclusive ? "exclusive" : "inclusive", time_std,
+               time_std_new);
+    }
+    printf("\n  ");
+}
@@ -152,5 +152,50 @@ DRJIT_TEST(test02_corner_case) {
     }
 
 
+    jit_shutdown(1);
+}
+
+DRJIT_TEST(test03_checkpoint) {
+    jit_init((uint32_t) JitBackend::LLVM);
+
+    auto func = [](const Vector3f &v, const Float &s) {
+        Vector3f r = v;
+        for (int i = 0; i < 4; ++i)
+            r = dr::normalize(r * s + v);
+        return r;
+    };
+
+    {
+        Vector3f d(1, 2, 3), d_ref(1, 2, 3);
+        Float s = 2.f, s_ref = 2.f;
+        dr::enable_grad(d, s, d_ref, s_ref);
+
+        Vector3f r = dr::checkpoint(func, d, s),
+                 r_ref = func(d_ref, s_ref);
+        assert(dr::allclose(r, r_ref));
+
+        dr::set_grad(r, Vector3f(5, 6, 7));
+        dr::set_grad(r_ref, Vector3f(5, 6, 7));
+        dr::enqueue(ADMode::Backward, r, r_ref);
+        dr::traverse<Float>(ADMode::Backward);
+        assert(dr::allclose(dr::grad(d), dr::grad(d_ref)));
+        assert(dr::allclose(dr::grad(s), dr::grad(s_ref)));
+    }
+
+    {
+        Vector3f d(1, 2, 3), d_ref(1, 2, 3);
+        Float s = 2.f, s_ref = 2.f;
+        dr::enable_grad(s, s_ref);
+
+        Vector3f r = dr::checkpoint(func, d, s),
+                 r_ref = func(d_ref, s_ref);
+
+        dr::set_grad(s, 1.f);
+        dr::set_grad(s_ref, 1.f);
+        dr::enqueue(ADMode::Forward, s, s_ref);
+        dr::traverse<Float>(ADMode::Forward);
+        assert(dr::allclose(dr::grad(r), dr::grad(r_ref)));
+    }
+
     jit_shutdown(1);
 }
@@ -12,6 +12,7 @@
 */
 
 #include "test.h"
+#include <drjit/half.h>
 
 DRJIT_TEST_FLOAT(test01_div_fp) {
     auto sample = test::sample_values<Value>();
@@ -241,3 +242,50 @@ DRJIT_TEST_FLOAT(test20_cbrt) {
     assert(drjit::cbrt(T(0)) == T(0));
     assert(drjit::cbrt(0.f) == 0.f);
 }
+
+DRJIT_TEST_FLOAT(test21_half) {
+    using Half = replace_scalar_t<T, half>;
+
+    // Every half precision value must survive a round trip
+    for (uint32_t i = 0; i < 65536; i += (uint32_t) Size) {
+        Half h;
+        for (size_t j = 0; j < Size; ++j)
+            h.entry(j) = half::from_binary((uint16_t) ((i + j) & 0xFFFF));
+
+        T f(h);
+        Half h2(f);
+        for (size_t j = 0; j < Size; ++j) {
+            Value ref = (Value) (float) h.entry(j);
+            if (std::isnan(ref)) {
+                assert(std::isnan(f.entry(j)));
+            } else {
+                assert(f.entry(j) == ref);
+                assert(h2.entry(j).value == h.entry(j).value);
+            }
+        }
+    }
+
+    // Rounding must match the scalar conversion
+    for (uint32_t i = 0; i < 10000; ++i) {
+        T f;
+        for (size_t j = 0; j < Size; ++j)
+            f.entry(j) = std::ldexp((Value) ((i * 7919 + j * 104729) % 100003) -
+                                        Value(50000), (int) (i % 40) - 30);
+        Half h(f);
+        for (size_t j = 0; j < Size; ++j)
+            assert(h.entry(j).value == half((float) f.entry(j)).value);
+    }
+
+    // Loads from half precision buffers
+    const size_t n = 1024;
+    std::vector<half> buf_h(n, half(1.f));
+    std::vector<Value> buf_f(n, Value(1));
+    T accum_h = 0, accum_f = 0;
+
+    for (size_t i = 0; i + Size <= n; i += Size) {
+        accum_h += T(load<Half>(buf_h.data() + i));
+        accum_f += load<T>(buf_f.data() + i);
+    }
+
+    assert(accum_h == accum_f);
+}
@@ -12,6 +12,9 @@
 */
 
 #include "test.h"
+#include <drjit/dynamic.h>
+#include <drjit/scan.h>
+#include <numeric>
 
 DRJIT_TEST_ALL(test01_sum) {
     auto sample = test::sample_values<Value>();
@@ -243,3 +246,85 @@ DRJIT_TEST_ALL(test13_max_inner_nested) {
     assert(max_inner(x) == y);
     assert(max_nested(x) == max(y));
 }
+
+DRJIT_TEST_ALL(test14_prefix_sum) {
+    Value data[Size], head_data[Size], incl[Size], excl[Size], seg[Size];
+
+    Value accum = Value(0), accum_seg = Value(0);
+    for (size_t i = 0; i < Size; ++i) {
+        data[i] = Value(i % 5 + 1);
+        head_data[i] = Value(i % 3 == 0 ? 1 : 0);
+        excl[i] = accum;
+        accum += data[i];
+        incl[i] = accum;
+        if (i % 3 == 0)
+            accum_seg = Value(0);
+        accum_seg += data[i];
+        seg[i] = accum_seg;
+    }
+
+    T x = load<T>(data), h = load<T>(head_data);
+    assert(prefix_sum(x) == load<T>(incl));
+    assert(prefix_sum(x, true) == load<T>(excl));
+    assert(segmented_prefix_sum(x, neq(h, Value(0))) == load<T>(seg));
+}
+
+DRJIT_TEST(test15_prefix_sum_dynamic) {
+    using FloatX  = DynamicArray<float>;
+    using UInt32X = DynamicArray<uint32_t>;
+    using MaskX   = DynamicArray<bool>;
+
+    const size_t n = 1000003;
+    FloatX x = empty<FloatX>(n);
+    UInt32X y = empty<UInt32X>(n);
+    for (size_t i = 0; i < n; ++i) {
+        x.entry(i) = float(i % 7);
+        y.entry(i) = uint32_t(i % 7);
+    }
+
+    for (int exclusive = 0; exclusive < 2; ++exclusive) {
+        FloatX r = prefix_sum(x, exclusive != 0),
+               ref = empty<FloatX>(n);
+        if (exclusive)
+            std::exclusive_scan(x.data(), x.data() + n, ref.data(), 0.f);
+        else
+            std::inclusive_scan(x.data(), x.data() + n, ref.data());
+
+        UInt32X r_u = prefix_sum(y, exclusive != 0),
+                ref_u = empty<UInt32X>(n);
+        if (exclusive)
+            std::exclusive_scan(y.data(), y.data() + n, ref_u.data(), 0u);
+        else
+            std::inclusive_scan(y.data(), y.data() + n, ref_u.data());
+
+        // Packetized scan of the same buffers (drjit/scan.h), in place
+        FloatX r2 = x.copy();
+        UInt32X r2_u = y.copy();
+        prefix_sum(r2.data(), r2.data(), n, exclusive != 0);
+        prefix_sum(r2_u.data(), r2_u.data(), n, exclusive != 0);
+
+        for (size_t i = 0; i < n; ++i) {
+            assert(r.entry(i) == ref.entry(i));
+            assert(r_u.entry(i) == ref_u.entry(i));
+            assert(r2.entry(i) == ref.entry(i));
+            assert(r2_u.entry(i) == ref_u.entry(i));
+        }
+
+        // Segments of 5 entries, and a single segment via a broadcast head
+        MaskX head = empty<MaskX>(n);
+        for (size_t i = 0; i < n; ++i)
+            head.entry(i) = i % 5 == 0;
+
+        UInt32X r3 = segmented_prefix_sum(y, head, exclusive != 0),
+                r4 = segmented_prefix_sum(y, MaskX(false), exclusive != 0);
+        uint32_t accum = 0;
+        for (size_t i = 0; i < n; ++i) {
+            if (i % 5 == 0)
+                accum = 0;
+            uint32_t value = uint32_t(i % 7);
+            assert(r3.entry(i) == (exclusive ? accum : accum + value));
+            assert(r4.entry(i) == ref_u.entry(i));
+            accum += value;
+        }
+    }
+}
@@ -198,3 +198,78 @@ DRJIT_TEST_ALL(test09_scatter_mask) {
     for (size_t i = 0; i < Size; ++i)
         assert(dst[i] == (((Size-1-i) % 2 == 0) ? Value(Size - 1 - i) : 0));
 }
+
+DRJIT_TEST_ALL(test10_scatter_reduce_ops) {
+    const ReduceOp ops[] = { ReduceOp::Add, ReduceOp::Mul, ReduceOp::Min,
+                             ReduceOp::Max, ReduceOp::And, ReduceOp::Or };
+    size_t op_count = std::is_floating_point_v<Value> ? 4 : 6;
+
+    using UInt32P = Array<uint32_t, Size>;
+    using UInt64P = Array<uint64_t, Size>;
+
+    // Vary the number of distinct targets, and hence the rate of collisions
+    for (size_t bins = 1; bins <= Size; bins *= 2) {
+        // Padding lanes (if any) are inactive and target index 0
+        Value mem[T::ActualSize] = { }, active[T::ActualSize] = { };
+        uint32_t indices32[UInt32P::ActualSize] = { };
+        uint64_t indices64[UInt64P::ActualSize] = { };
+        for (size_t i = 0; i < Size; ++i) {
+            mem[i] = (Value) ((i * 7) % 3 + 1);
+            active[i] = (Value) (i % 4 != 3);
+            indices32[i] = uint32_t(i % bins);
+            indices64[i] = uint64_t(i % bins);
+        }
+        auto id32 = load<UInt32P>(indices32);
+        auto id64 = load<UInt64P>(indices64);
+        auto mask = neq(load<T>(active), Value(0));
+
+        for (size_t k = 0; k < op_count; ++k) {
+            Value ref[Size], dst32[Size], dst64[Size];
+            for (size_t i = 0; i < Size; ++i)
+                ref[i] = dst32[i] = dst64[i] = (Value) (i % 3 + 2);
+
+            for (size_t i = 0; i < Size; ++i) {
+                if (active[i] != 0)
+                    scatter_reduce(ops[k], ref, mem[i], indices32[i]);
+            }
+
+            scatter_reduce(ops[k], dst32, load<T>(mem), id32, mask);
+            scatter_reduce(ops[k], dst64, load<T>(mem), id64, mask);
+#if defined(_MSC_VER)
+            MemoryBarrier();
+#endif
+            for (size_t i = 0; i < Size; ++i)
+                assert(dst32[i] == ref[i] && dst64[i] == ref[i]);
+        }
+    }
+}
+
+DRJIT_TEST_ALL(test11_compress_store) {
+    Value mem[T::ActualSize], active[T::ActualSize];
+    for (size_t i = 0; i < T::ActualSize; ++i) {
+        mem[i] = (Value) (i + 1);
+        active[i] = (Value) 1; // Padding lanes (if any) are active
+    }
+
+    for (uint32_t trial = 0; trial < 256; ++trial) {
+        uint32_t bits = trial * 0x9E3779B1u;
+        for (size_t i = 0; i < Size; ++i)
+            active[i] = (Value) ((bits >> (i % 32)) & 1);
+        if (trial == 0 || trial == 1)
+            for (size_t i = 0; i < Size; ++i)
+                active[i] = (Value) trial;
+
+        Value ref[Size], dst[T::ActualSize * 2];
+        size_t ref_count = 0;
+        for (size_t i = 0; i < Size; ++i) {
+            if (active[i] != 0)
+                ref[ref_count++] = mem[i];
+        }
+
+        size_t count = compress_store(dst, load<T>(mem),
+                                      neq(load<T>(active), Value(0)));
+        assert(count == ref_count);
+        for (size_t i = 0; i < count; ++i)
+            assert(dst[i] == ref[i]);
+    }
+}
@@ -1942,3 +1942,266 @@ def test80_backward_from_complex(m):
     b = 2 * a
     dr.backward_from(b)
     assert dr.allclose(dr.grad(a), m.Complex2f(0, 2))
+
+
+def test81_tape_replay(m):
+    def optimize(use_tape):
+        x = m.Float(1, 2, 3)
+        tape = dr.ADTape(m.Float) if use_tape else None
+        for i in range(4):
+            dr.enable_grad(x)
+            if use_tape:
+                with tape:
+                    y = dr.sum(dr.sin(x) * x + 2 * x)
+                    tape.backward(y)
+                assert tape.recorded
+            else:
+                y = dr.sum(dr.sin(x) * x + 2 * x)
+                dr.backward(y)
+            x = dr.detach(x) - 0.1 * dr.grad(x)
+        return x
+
+    assert dr.allclose(optimize(True), optimize(False))
+
+
+def test82_tape_replay_mismatch(m):
+    tape = dr.ADTape(m.Float)
+    x = m.Float(1, 2)
+    dr.enable_grad(x)
+
+    with tape:
+        tape.backward(dr.sum(x * x))
+
+    with pytest.raises(Exception, match='differs from the one captured'):
+        with tape:
+            tape.backward(dr.sum(x + x * 2))
+
+
+def test83_checkpoint(m):
+    def func(x, s):
+        for i in range(4):
+            x = dr.sin(x) * s + x
+        return x
+
+    x, s = m.Float(1, 2, 3), m.Float(2)
+    dr.enable_grad(x, s)
+    y = dr.checkpoint(func, x, s)
+    dr.backward(y)
+
+    x_ref, s_ref = m.Float(1, 2, 3), m.Float(2)
+    dr.enable_grad(x_ref, s_ref)
+    y_ref = func(x_ref, s_ref)
+    dr.backward(y_ref)
+
+    assert dr.allclose(y, y_ref)
+    assert dr.allclose(dr.grad(x), dr.grad(x_ref))
+    assert dr.allclose(dr.grad(s), dr.grad(s_ref))
+
+    # Forward mode
+    s = m.Float(2)
+    dr.enable_grad(s)
+    y = dr.checkpoint(func, m.Float(1, 2, 3), s)
+    dr.forward(s)
+
+    s_ref = m.Float(2)
+    dr.enable_grad(s_ref)
+    y_ref = func(m.Float(1, 2, 3), s_ref)
+    dr.forward(s_ref)
+    assert dr.allclose(dr.grad(y), dr.grad(y_ref))
+
+
+def test84_checkpoint_sequential(m):
+    funcs = [lambda x, i=i: dr.sin(x) * (i + 1) * 0.25 + x for i in range(10)]
+
+    x = m.Float(1, 2, 3)
+    dr.enable_grad(x)
+    y = x
+    for f in funcs:
+        y = f(y)
+    dr.backward(y)
+    grad_ref = dr.grad(x)
+
+    for segments in [1, 3, 10]:
+        x = m.Float(1, 2, 3)
+        dr.enable_grad(x)
+        y2 = dr.checkpoint_sequential(funcs, x, segments)
+        dr.backward(y2)
+        assert dr.allclose(y2, y)
+        assert dr.allclose(dr.grad(x), grad_ref)
+
+
+def test85_ad_stats(m):
+    dr.ad_stats_reset()
+    x = m.Float(1, 2, 3)
+    dr.enable_grad(x)
+    y = dr.gather(m.Float, x, m.UInt32(0, 2))
+    z = dr.sum(y * 2)
+
+    stats = dr.ad_stats()
+    assert stats['gather_edges'] == 1
+    assert stats['edges_created'] >= 3
+    assert stats['edges_live'] >= 3
+    assert stats['traversals'] == 0
+
+    dr.backward(z)
+    stats = dr.ad_stats()
+    assert stats['traversals'] == 1
+    assert stats['edges_traversed'] >= 3
+    assert stats['traverse_time'] >= 0
+    assert dr.allclose(dr.grad(x), [2, 0, 2])
+
+
+def test86_forward_batch(m):
+    x = m.Array3f(1, 2, 3)
+    dr.enable_grad(x)
+    y = m.Array2f(x.x * x.y, dr.sin(x.z) + x.x)
+
+    tangents = [m.Array3f(1, 0, 0), m.Array3f(0, 1, 0), m.Array3f(0, 0, 1)]
+    result = dr.forward_batch(x, tangents, y)
+    assert len(result) == 3
+    assert dr.allclose(result[0], [2, 1])
+    assert dr.allclose(result[1], [1, 0])
+    assert dr.allclose(result[2], [0, dr.cos(3)])
+
+    # The gradients of the graph are left untouched
+    assert dr.allclose(dr.grad(y), 0)
+
+
+def test87_grad_sparse(m):
+    n = 1 << 20
+    x = dr.zeros(m.Float, n)
+    dr.enable_grad(x)
+    y = dr.gather(m.Float, x, m.UInt32(5, 7, 5, 9), m.Bool(True, True, True, False))
+    dr.backward(dr.sum(y * m.Float(1, 2, 3, 4)))
+
+    offsets, values = dr.grad_sparse(x)
+    assert len(offsets) == len(values)
+    dense = dr.zeros(m.Float, n)
+    dr.scatter_reduce(dr.ReduceOp.Add, dense, values, offsets)
+
+    target = dr.zeros(m.Float, n)
+    dr.accum_grad_into(x, target)
+    assert dr.all(dr.eq(target, dense))
+
+    # Densified on demand
+    g = dr.grad(x)
+    assert dr.all(dr.eq(g, dense))
+    assert g[5] == 4 and g[7] == 2 and g[9] == 0 and dr.sum(g)[0] == 6
+
+
+def test88_gather_combined_backward(m):
+    x = m.Float(1, 2, 3, 4)
+    dr.enable_grad(x)
+    idx = m.UInt32(0, 2, 2, 3)
+    y = dr.gather(m.Float, x, idx) * 2 + dr.gather(m.Float, x, idx) * 3 + \
+        dr.gather(m.Float, x, m.UInt32(1, 1))
+    dr.backward(y, dr.ADFlag.Default | dr.ADFlag.CombineGathers)
+
+    # Both gathers with offsets 'idx' share one entry
+    offsets, values = dr.grad_sparse(x)
+    assert len(offsets) == 6
+    assert dr.allclose(dr.grad(x), [5, 2, 10, 5])
+
+    # Gathers from small arrays are scattered right away by default
+    x2 = m.Float(1, 2, 3, 4)
+    dr.enable_grad(x2)
+    dr.backward(dr.gather(m.Float, x2, idx) * 2)
+    offsets, values = dr.grad_sparse(x2)
+    assert len(offsets) == 4
+    assert dr.allclose(dr.grad(x2), [2, 0, 4, 2])
+
+
+def test89_scalar_deferred_reduction(m):
+    n = 16
+    c = [dr.arange(m.Float, 100) + i for i in range(n)]
+    dr.eval(c)
+
+    def run():
+        x = m.Float(2)
+        dr.enable_grad(x)
+
+        # 'x' is broadcast to 'n' wide consumers
+        y = m.Float(0)
+        for i in range(n):
+            y += dr.sum(x * c[i] * c[i])
+
+        dr.kernel_history_clear()
+        with dr.scoped_set_flag(dr.JitFlag.KernelHistory, True):
+            dr.backward(y)
+            g = dr.grad(x)
+            dr.eval(g)
+            history = dr.kernel_history([dr.KernelType.Reduce])
+        return g, len(history)
+
+    g0, count0 = run()
+    with dr.scoped_set_flag(dr.JitFlag.ADOptimize, False):
+        g1, count1 = run()
+
+    # The contributions are summed element-wise and reduced once
+    assert count0 == 1 and count1 >= n
+    assert dr.allclose(g0, g1)
+    assert dr.allclose(g0, sum(dr.sum(c[i] * c[i])[0] for i in range(n)))
+
+
+def test91_traverse_releases_gil(m):
+    import threading
+
+    class Scale(dr.CustomOp):
+        def eval(self, value):
+            return value * 2
+
+        def forward(self):
+            self.set_grad_out(self.grad_in('value') * 2)
+
+        def backward(self):
+            self.set_grad_in('value', self.grad_out() * 2)
+
+    x = m.Float(1)
+    dr.enable_grad(x)
+    y = dr.custom(Scale, x)
+    for i in range(20000):
+        y = dr.fma(y, 0.5, x)
+
+    started, done = threading.Event(), threading.Event()
+
+    def worker():
+        started.set()
+        dr.backward(y)
+        done.set()
+
+    thread = threading.Thread(target=worker)
+    thread.start()
+    started.wait()
+
+    # Other threads make progress (including graph construction) meanwhile
+    ticks = 0
+    while not done.is_set():
+        w = m.Float(3)
+        dr.enable_grad(w)
+        w = w * 2
+        ticks += 1
+    thread.join()
+
+    assert ticks > 10
+    assert dr.allclose(dr.grad(x), 2)
+
+
+def test92_tape_replay_checkpoint(m):
+    def func(x):
+        for i in range(3):
+            x = dr.sin(x) * 0.5 + x
+        return x
+
+    x_ref = m.Float(1, 2, 3)
+    dr.enable_grad(x_ref)
+    dr.backward(dr.sum(func(x_ref) * x_ref))
+
+    # Checkpoints traverse a recomputed graph while the tape is capturing
+    tape = dr.ADTape(m.Float)
+    for i in range(3):
+        x = m.Float(1, 2, 3)
+        dr.enable_grad(x)
+        with tape:
+            tape.backward(dr.sum(dr.checkpoint(func, x) * x))
+        assert tape.recorded
+        assert dr.allclose(dr.grad(x), dr.grad(x_ref))
@@ -86,9 +86,13 @@ DRJIT_TEST(test01_vcall_reduce_and_record) {
     else
         jit_init((uint32_t) JitBackend::LLVM);
 
-    for (int i = 0; i < 3; ++i) {
-        jit_set_flag(JitFlag::VCallRecord, i != 0);
+    /* i == 3: reduce mode with arguments reordered by instance,
+       i == 4: reduce mode with merged launches */
+    for (int i = 0; i < 5; ++i) {
+        jit_set_flag(JitFlag::VCallRecord, i == 1 || i == 2);
         jit_set_flag(JitFlag::VCallOptimize, i == 2);
+        dr::set_vcall_reorder(i == 3);
+        dr::set_vcall_merge(i == 4);
 
         for (int j = 0; j < 2; ++j) {
             A *a = new A(j != 0);
@@ -129,6 +133,8 @@ DRJIT_TEST(test01_vcall_reduce_and_record) {
             delete b;
         }
     }
+    dr::set_vcall_reorder(false);
+    dr::set_vcall_merge(false);
 }
 
 DRJIT_TEST(test02_vcall_reduce_and_record_masked) {
@@ -143,9 +149,13 @@ DRJIT_TEST(test02_vcall_reduce_and_record_masked) {
 
     jit_set_log_level_stderr(::LogLevel::Error);
 
-    for (int i = 0; i < 3; ++i) {
-        jit_set_flag(JitFlag::VCallRecord, i != 0);
+    /* i == 3: reduce mode with arguments reordered by instance,
+       i == 4: reduce mode with merged launches */
+    for (int i = 0; i < 5; ++i) {
+        jit_set_flag(JitFlag::VCallRecord, i == 1 || i == 2);
         jit_set_flag(JitFlag::VCallOptimize, i == 2);
+        dr::set_vcall_reorder(i == 3);
+        dr::set_vcall_merge(i == 4);
 
         for (int j = 0; j < 2; ++j) {
             A *a = new A(j != 0);
@@ -181,6 +191,8 @@ DRJIT_TEST(test02_vcall_reduce_and_record_masked) {
             delete b;
         }
     }
+    dr::set_vcall_reorder(false);
+    dr::set_vcall_merge(false);
 }
 
 struct BaseD {
@@ -200,6 +212,9 @@ struct BaseD {
 
 using BasePtrD = dr::replace_scalar_t<FloatD, BaseD *>;
 
+/// Number of times that an implementation of BaseD::g() was invoked
+static uint32_t g_calls = 0;
+
 struct AD : BaseD {
     StructFD f(const StructFD &m) override {
         return { m.a * 2, m.b * 3 };
@@ -211,6 +226,7 @@ struct AD : BaseD {
     }
 
     StructFD g(const StructFD &m) override {
+        g_calls++;
         return { m.a * x, m.b * 3 };
     }
 };
@@ -226,6 +242,7 @@ struct BD : BaseD {
     }
 
     StructFD g(const StructFD &m) override {
+        g_calls++;
         return { m.b * 4, m.a + x };
     }
 };
@@ -419,3 +436,164 @@ DRJIT_TEST(test05_vcall_symbolic_ad_bwd_accessing_local) {
         delete b;
     }
 }
+
+DRJIT_TEST(test06_vcall_ad_zero_grad) {
+    if constexpr (dr::is_cuda_v<Float>)
+        jit_init((uint32_t) JitBackend::CUDA);
+    else
+        jit_init((uint32_t) JitBackend::LLVM);
+
+    const uint32_t n_inst = 100, n = 1000;
+    const uint32_t flags = (uint32_t) ADFlag::ClearVertices;
+    jit_set_flag(JitFlag::VCallRecord, true);
+    jit_set_flag(JitFlag::VCallOptimize, true);
+
+    std::vector<BaseD *> inst(n_inst);
+    for (uint32_t i = 0; i < n_inst; ++i)
+        inst[i] = (i & 1) ? (BaseD *) new AD() : (BaseD *) new BD();
+
+    UInt32D idx = dr::arange<UInt32D>(n) % n_inst;
+    BasePtrD arr = dr::select(dr::eq(idx, 0u), inst[0], inst[1]);
+    for (uint32_t i = 2; i < n_inst; ++i)
+        arr = dr::select(dr::eq(idx, i), inst[i], arr);
+
+    Float o = dr::full<Float>(1, n);
+    StructFD input{ Array3fD(1, 2, 3) * o, Array3fD(4, 5, 6) * o };
+    dr::enable_grad(input);
+
+    StructFD output = arr->g(input);
+    uint32_t calls = g_calls;
+
+    // A zero output gradient does not record the instances again
+    dr::enqueue(ADMode::Backward, output);
+    dr::set_grad(output, StructF(0, 0));
+    dr::traverse<FloatD>(ADMode::Backward, flags);
+    assert(g_calls == calls);
+
+    StructF grad_in = dr::grad(input);
+    assert(dr::all_nested(dr::eq(grad_in.a, 0.f) && dr::eq(grad_in.b, 0.f)));
+
+    // .. and likewise for zero input tangents in forward mode
+    dr::enqueue(ADMode::Forward, input);
+    dr::set_grad(input, StructF(0, 0));
+    dr::traverse<FloatD>(ADMode::Forward, flags);
+    assert(g_calls == calls);
+
+    // A nonzero gradient records every instance once
+    dr::enqueue(ADMode::Backward, output);
+    dr::set_grad(output, StructF(2, 10));
+    dr::traverse<FloatD>(ADMode::Backward, flags);
+    assert(g_calls == calls + n_inst);
+
+    grad_in = dr::grad(input);
+    assert(dr::all_nested(dr::neq(grad_in.a, 0.f)));
+
+    for (BaseD *p : inst)
+        delete p;
+}
+
+using FloatP = dr::Packet<float>;
+using MaskP  = dr::mask_t<FloatP>;
+
+struct BaseP {
+    virtual ~BaseP() { }
+    virtual FloatP f(const FloatP &x, MaskP active = true) const = 0;
+    DRJIT_VCALL_REGISTER(FloatP, BaseP)
+};
+
+struct ScaleP : BaseP {
+    ScaleP(float scale) : scale(scale) { }
+    FloatP f(const FloatP &x, MaskP active) const override {
+        return dr::select(active, x * scale, 0.f);
+    }
+    float scale;
+};
+
+DRJIT_VCALL_BEGIN(BaseP)
+DRJIT_VCALL_METHOD(f)
+DRJIT_VCALL_END(BaseP)
+
+using BasePtrP = dr::replace_scalar_t<FloatP, BaseP *>;
+
+DRJIT_TEST(test07_vcall_packet_divergent) {
+    const size_t n = FloatP::Size;
+    std::vector<BaseP *> inst;
+    for (size_t i = 0; i < n; ++i)
+        inst.push_back(new ScaleP(float(i + 1)));
+
+    FloatP x = dr::arange<FloatP>() + 1.f;
+    for (size_t distinct = 1; distinct <= n; distinct *= 2) {
+        // Lane 'i' refers to instance 'i % distinct', every third lane is null
+        BasePtrP self;
+        for (size_t i = 0; i < n; ++i)
+            self.entry(i) = (i % 3 == 2) ? nullptr : inst[i % distinct];
+        MaskP active = dr::neq(dr::arange<FloatP>(), 5.f);
+
+        FloatP result = self->f(x, active);
+        for (size_t i = 0; i < n; ++i) {
+            float ref = (i % 3 == 2 || i == 5) ? 0.f : (i + 1.f) * (i % distinct + 1.f);
+            assert(result.entry(i) == ref);
+        }
+    }
+
+    for (BaseP *p : inst)
+        delete p;
+}
+
+DRJIT_TEST(test08_vcall_merge_many_instances) {
+    if constexpr (dr::is_cuda_v<Float>)
+        jit_init((uint32_t) JitBackend::CUDA);
+    else
+        jit_init((uint32_t) JitBackend::LLVM);
+
+    const uint32_t n = 9999;
+    jit_set_flag(JitFlag::VCallRecord, false);
+    dr::set_vcall_merge(true);
+
+    uint32_t launches[2] { };
+    for (int k = 0; k < 2; ++k) {
+        uint32_t n_inst = k == 0 ? 10 : 100;
+        std::vector<Base *> inst(n_inst);
+        for (uint32_t i = 0; i < n_inst; ++i)
+            inst[i] = (i & 1) ? (Base *) new B(true) : (Base *) new A(true);
+
+        UInt32 idx = dr::arange<UInt32>(n) % n_inst;
+        BasePtr arr = dr::select(dr::eq(idx, 0u), inst[0], inst[1]);
+        for (uint32_t i = 2; i < n_inst; ++i)
+            arr = dr::select(dr::eq(idx, i), inst[i], arr);
+        ::Mask m = dr::eq(idx & 1, 1u);
+        dr::eval(arr, m);
+
+        Float o = dr::full<Float>(1, n);
+        StructF input{ Array3f(1, 2, 3) * o, Array3f(4, 5, 6) * o };
+        dr::eval(input);
+
+        jit_set_flag(JitFlag::KernelHistory, true);
+        StructF result = arr->f(input);
+        dr::eval(result);
+        jit_sync_thread();
+
+        // Count the kernel launches issued by the virtual function call
+        KernelHistoryEntry *history = jit_kernel_history();
+        for (KernelHistoryEntry *e = history; e && (uint32_t) e->backend; ++e) {
+            if (e->type == KernelType::JIT)
+                launches[k]++;
+            free(e->ir);
+        }
+        free(history);
+        jit_set_flag(JitFlag::KernelHistory, false);
+
+        assert(dr::all_nested(
+            dr::eq(result.a, dr::select(m, Array3f(80.f, 100.f, 120.f),
+                                           Array3f(10.f, 20.f, 30.f))) &&
+            dr::eq(result.b, dr::select(m, Array3f(10.f, 20.f, 30.f),
+                                           Array3f(60.f, 75.f, 90.f)))));
+
+        for (Base *p : inst)
+            delete p;
+    }
+
+    // The number of launches does not depend on the number of instances
+    assert(launches[0] == launches[1]);
+    dr::set_vcall_merge(false);
+}